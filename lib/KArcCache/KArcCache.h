@@ -1,28 +1,62 @@
 #pragma once
 
+#include "../KCacheDump.h"
 #include "../KICachePolicy.h"
+#include "KArcClassicCore.h"
 #include "KArcLruPart.h"
 #include "KArcLfuPart.h"
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace KamaCache 
 {
 
+// Split：LRU/LFU两部分各自管理容量，幽灵命中时逐个位置地在两部分之间挪动容量；
+// Classic：教科书式ARC，T1/T2/B1/B2加自适应目标p，每个key只驻留一份
+enum class ArcMode
+{
+    Split,
+    Classic
+};
+
+// ARC各段的快照：T1/T2为驻留数据，B1/B2为幽灵链表中的key
+template<typename Key, typename Value>
+struct ArcSnapshot
+{
+    std::vector<std::pair<Key, Value>> t1; // Split模式为LRU部分；MRU -> LRU
+    std::vector<std::pair<Key, Value>> t2; // Split模式为LFU部分，频次从高到低；Classic模式为MRU -> LRU
+    std::vector<Key>                   b1; // T1的幽灵，最新淘汰的在前
+    std::vector<Key>                   b2; // T2的幽灵，最新淘汰的在前
+};
+
 template<typename Key, typename Value>
 class KArcCache : public KICachePolicy<Key, Value> 
 {
 public:
-    explicit KArcCache(size_t capacity = 10, size_t transformThreshold = 2)
+    explicit KArcCache(size_t capacity = 10, size_t transformThreshold = 2, ArcMode mode = ArcMode::Split)
         : capacity_(capacity)
         , transformThreshold_(transformThreshold)
-        , lruPart_(std::make_unique<ArcLruPart<Key, Value>>(capacity, transformThreshold))
-        , lfuPart_(std::make_unique<ArcLfuPart<Key, Value>>(capacity, transformThreshold))
-    {}
+    {
+        if (mode == ArcMode::Classic)
+        {
+            classicCore_ = std::make_unique<ArcClassicCore<Key, Value>>(capacity);
+        }
+        else
+        {
+            lruPart_ = std::make_unique<ArcLruPart<Key, Value>>(capacity, transformThreshold);
+            lfuPart_ = std::make_unique<ArcLfuPart<Key, Value>>(capacity, transformThreshold);
+        }
+    }
 
     ~KArcCache() override = default;
 
     void put(Key key, Value value) override 
     {
+        if (classicCore_)
+            return classicCore_->put(key, value);
+
         checkGhostCaches(key);
 
         // 检查 LFU 部分是否存在该键
@@ -38,6 +72,9 @@ public:
 
     bool get(Key key, Value& value) override 
     {
+        if (classicCore_)
+            return classicCore_->get(key, value);
+
         checkGhostCaches(key);
 
         bool shouldTransform = false;
@@ -59,6 +96,85 @@ public:
         return value;
     }
 
+    // 只读查询：不更新访问计数，也不检查幽灵缓存(不会触发容量调整)
+    bool peek(Key key, Value& value)
+    {
+        if (classicCore_)
+            return classicCore_->peek(key, value);
+        return lruPart_->peek(key, value) || lfuPart_->peek(key, value);
+    }
+
+    bool contains(Key key)
+    {
+        if (classicCore_)
+            return classicCore_->contain(key);
+        return lruPart_->contain(key) || lfuPart_->contain(key);
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+    // 批量预热：数据全部进入LRU部分/T1(相当于只被访问过一次)
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        if (classicCore_)
+            return classicCore_->bulkLoad(first, last);
+        lruPart_->bulkLoad(first, last);
+    }
+
+    // 运行时调整容量(至少为1)。Split模式下两部分合计仍为2*capacity(与构造时一致)，
+    // 按两部分当前容量的比例重新分配，保留已经学到的LRU/LFU倾向；超出部分移入幽灵缓存
+    void setCapacity(size_t capacity)
+    {
+        capacity = std::max<size_t>(capacity, 1);
+        capacity_ = capacity;
+        if (classicCore_)
+            return classicCore_->setCapacity(capacity);
+
+        size_t lruCapacity = lruPart_->capacity();
+        size_t lfuCapacity = lfuPart_->capacity();
+        size_t total = 2 * capacity;
+        size_t lruShare = lruCapacity + lfuCapacity == 0 ? capacity : total * lruCapacity / (lruCapacity + lfuCapacity);
+        lruPart_->setCapacity(lruShare, capacity);
+        lfuPart_->setCapacity(total - lruShare, capacity);
+    }
+
+    // 按最多驻留的条目数设置容量。Split模式下两部分合计最多驻留2*capacity条(同一key可能同时在两部分中)，
+    // 所以按entries/2设置；按内存预算分配容量的调用方(如KCacheBalancer)应使用这个接口
+    void setResidentCapacity(size_t entries)
+    {
+        setCapacity(classicCore_ ? entries : std::max<size_t>(1, entries / 2));
+    }
+
+    // 拷贝出T1/T2/B1/B2，两个部分各自只在拷贝期间持有自己的锁
+    ArcSnapshot<Key, Value> snapshot()
+    {
+        ArcSnapshot<Key, Value> result;
+        if (classicCore_)
+        {
+            classicCore_->snapshot(result.t1, result.t2, result.b1, result.b2);
+            return result;
+        }
+        lruPart_->snapshot(result.t1, result.b1);
+        lfuPart_->snapshot(result.t2, result.b2);
+        return result;
+    }
+
+    // 依次分块导出T1、T2中的驻留数据，回调在锁外执行
+    template<typename Fn>
+    void dump(Fn fn, size_t chunkSize = 256)
+    {
+        ArcSnapshot<Key, Value> result = snapshot();
+        streamInChunks(std::move(result.t1), chunkSize, fn);
+        streamInChunks(std::move(result.t2), chunkSize, fn);
+    }
+
 private:
     bool checkGhostCaches(Key key) 
     {
@@ -85,8 +201,9 @@ private:
 private:
     size_t capacity_;
     size_t transformThreshold_;
-    std::unique_ptr<ArcLruPart<Key, Value>> lruPart_;
-    std::unique_ptr<ArcLfuPart<Key, Value>> lfuPart_;
+    std::unique_ptr<ArcLruPart<Key, Value>>     lruPart_;     // Split模式
+    std::unique_ptr<ArcLfuPart<Key, Value>>     lfuPart_;     // Split模式
+    std::unique_ptr<ArcClassicCore<Key, Value>> classicCore_; // Classic模式
 };
 
 } // namespace KamaCache
\ No newline at end of file
@@ -26,7 +26,7 @@ public:
     {}
 
     // Getters
-    Key getKey() const { return key_; }
+    const Key& getKey() const { return key_; }
     Value getValue() const { return value_; }
     size_t getAccessCount() const { return accessCount_; }
     
@@ -36,6 +36,7 @@ public:
 
     template<typename K, typename V> friend class ArcLruPart;
     template<typename K, typename V> friend class ArcLfuPart;
+    template<typename K, typename V> friend class ArcClassicCore;
 };
 
 } // namespace KamaCache
\ No newline at end of file
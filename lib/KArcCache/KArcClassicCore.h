@@ -0,0 +1,324 @@
+#pragma once
+
+#include "KArcCacheNode.h"
+#include "../KKeyRef.h"
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace KamaCache
+{
+
+// 教科书式ARC(Megiddo & Modha)：T1/T2保存驻留数据，B1/B2是它们各自的幽灵链表，
+// T1的目标大小p按B1/B2命中时两者长度的比例自适应调整。
+// 每个key只驻留一份，结点在四个链表之间迁移时只调整指针，不重新分配、不拷贝
+template<typename Key, typename Value>
+class ArcClassicCore
+{
+public:
+    using NodeType = ArcNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+
+    enum Segment { T1 = 0, T2, B1, B2, SegmentCount };
+
+private:
+    struct Entry
+    {
+        NodePtr node;
+        Segment segment;
+        bool    adapted; // 幽灵命中时已在get中调整过p，随后的put不再重复调整
+    };
+
+    struct List
+    {
+        NodePtr head; // head一侧为MRU
+        NodePtr tail; // tail一侧为LRU
+        size_t  size = 0;
+    };
+
+    using EntryMap = std::unordered_map<KeyRef<Key>, Entry>;
+
+public:
+    explicit ArcClassicCore(size_t capacity)
+        : capacity_(capacity)
+        , p_(0)
+    {
+        for (auto& list : lists_)
+        {
+            list.head = std::make_shared<NodeType>();
+            list.tail = std::make_shared<NodeType>();
+            list.head->next_ = list.tail;
+            list.tail->prev_ = list.head;
+        }
+    }
+
+    void put(Key key, Value value)
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        putInternal(key, value);
+    }
+
+    bool get(Key key, Value& value)
+    {
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(KeyRef<Key>(key));
+        if (it == entries_.end())
+            return false;
+
+        Entry& entry = it->second;
+        if (isResident(entry))
+        {
+            // 命中T1或T2：迁移到T2的MRU端
+            moveTo(entry, T2);
+            entry.node->incrementAccessCount();
+            value = entry.node->getValue();
+            return true;
+        }
+
+        // 幽灵命中：没有value可返回，但先根据命中的幽灵链表调整p
+        if (!entry.adapted)
+        {
+            adapt(entry.segment);
+            entry.adapted = true;
+        }
+        return false;
+    }
+
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        for (; first != last; ++first)
+        {
+            putInternal(std::get<0>(*first), std::get<1>(*first));
+        }
+    }
+
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(KeyRef<Key>(key));
+        if (it == entries_.end() || !isResident(it->second))
+            return false;
+        value = it->second.node->getValue();
+        return true;
+    }
+
+    bool contain(Key key)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(KeyRef<Key>(key));
+        return it != entries_.end() && isResident(it->second);
+    }
+
+    // 拷贝出四个链表，均为MRU在前
+    void snapshot(std::vector<std::pair<Key, Value>>& t1, std::vector<std::pair<Key, Value>>& t2,
+                  std::vector<Key>& b1, std::vector<Key>& b2)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        copyResident(lists_[T1], t1);
+        copyResident(lists_[T2], t2);
+        copyGhost(lists_[B1], b1);
+        copyGhost(lists_[B2], b2);
+    }
+
+    size_t target()
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return p_;
+    }
+
+    // 运行时调整容量：驻留数据超出部分降级到幽灵链表，再按|T1|+|B1|<=c、总数<=2c裁剪幽灵链表
+    void setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        capacity_ = capacity;
+        p_ = std::min(p_, capacity_);
+        while (lists_[T1].size + lists_[T2].size > capacity_)
+            replace(false);
+        while (lists_[T1].size + lists_[B1].size > capacity_ && lists_[B1].size > 0)
+            discardLeastRecent(B1);
+        while (totalSize() > 2 * capacity_ && lists_[B2].size > 0)
+            discardLeastRecent(B2);
+        while (totalSize() > 2 * capacity_ && lists_[B1].size > 0)
+            discardLeastRecent(B1);
+    }
+
+private:
+    size_t totalSize() const
+    {
+        return lists_[T1].size + lists_[T2].size + lists_[B1].size + lists_[B2].size;
+    }
+
+    void putInternal(const Key& key, const Value& value)
+    {
+        auto it = entries_.find(KeyRef<Key>(key));
+        if (it != entries_.end())
+        {
+            Entry& entry = it->second;
+            if (isResident(entry))
+            {
+                entry.node->setValue(value);
+                moveTo(entry, T2);
+                return;
+            }
+
+            // 幽灵命中(B1或B2)：调整p，腾出一个位置，再把原结点迁回T2
+            if (!entry.adapted)
+                adapt(entry.segment);
+            replace(entry.segment == B2);
+            entry.adapted = false;
+            entry.node->setValue(value);
+            moveTo(entry, T2);
+            return;
+        }
+
+        // 完全未命中
+        size_t t1 = lists_[T1].size;
+        size_t b1 = lists_[B1].size;
+        if (t1 + b1 >= capacity_)
+        {
+            if (t1 < capacity_)
+            {
+                discardLeastRecent(B1);
+                replace(false);
+            }
+            else
+            {
+                // B1为空且T1已满，直接丢弃T1的LRU结点
+                discardLeastRecent(T1);
+            }
+        }
+        else
+        {
+            size_t total = t1 + b1 + lists_[T2].size + lists_[B2].size;
+            if (total >= capacity_)
+            {
+                if (total >= 2 * capacity_)
+                    discardLeastRecent(B2);
+                replace(false);
+            }
+        }
+
+        NodePtr node = std::make_shared<NodeType>(key, value);
+        pushFront(lists_[T1], node);
+        entries_.emplace(KeyRef<Key>(node->getKey()), Entry{node, T1, false});
+    }
+
+    // 按命中的幽灵链表调整p：B1命中说明T1应更大，B2命中说明T2应更大
+    void adapt(Segment ghost)
+    {
+        size_t b1 = lists_[B1].size;
+        size_t b2 = lists_[B2].size;
+        if (ghost == B1)
+        {
+            size_t delta = (b1 >= b2 || b1 == 0) ? 1 : b2 / b1;
+            p_ = std::min(p_ + delta, capacity_);
+        }
+        else
+        {
+            size_t delta = (b2 >= b1 || b2 == 0) ? 1 : b1 / b2;
+            p_ = p_ > delta ? p_ - delta : 0;
+        }
+    }
+
+    // 将T1或T2的LRU结点降级到对应的幽灵链表
+    void replace(bool hitInB2)
+    {
+        size_t t1 = lists_[T1].size;
+        if (t1 >= 1 && ((hitInB2 && t1 == p_) || t1 > p_))
+            demoteLeastRecent(T1, B1);
+        else if (lists_[T2].size > 0)
+            demoteLeastRecent(T2, B2);
+        else if (t1 > 0)
+            demoteLeastRecent(T1, B1);
+    }
+
+    void demoteLeastRecent(Segment from, Segment to)
+    {
+        NodePtr node = lists_[from].tail->prev_.lock();
+        Entry& entry = entries_.find(KeyRef<Key>(node->getKey()))->second;
+        moveTo(entry, to);
+        // 幽灵结点只需要key，释放value占用的内存
+        node->setValue(Value());
+        node->accessCount_ = 1;
+    }
+
+    void discardLeastRecent(Segment segment)
+    {
+        NodePtr node = lists_[segment].tail->prev_.lock();
+        if (!node || node == lists_[segment].head)
+            return;
+        unlink(lists_[segment], node);
+        entries_.erase(KeyRef<Key>(node->getKey()));
+    }
+
+    void moveTo(Entry& entry, Segment segment)
+    {
+        unlink(lists_[entry.segment], entry.node);
+        pushFront(lists_[segment], entry.node);
+        entry.segment = segment;
+    }
+
+    void pushFront(List& list, NodePtr node)
+    {
+        node->next_ = list.head->next_;
+        node->prev_ = list.head;
+        list.head->next_->prev_ = node;
+        list.head->next_ = node;
+        ++list.size;
+    }
+
+    void unlink(List& list, NodePtr node)
+    {
+        if (!node->prev_.expired() && node->next_)
+        {
+            auto prev = node->prev_.lock();
+            prev->next_ = node->next_;
+            node->next_->prev_ = prev;
+            node->next_ = nullptr;
+            --list.size;
+        }
+    }
+
+    static bool isResident(const Entry& entry)
+    {
+        return entry.segment == T1 || entry.segment == T2;
+    }
+
+    static void copyResident(const List& list, std::vector<std::pair<Key, Value>>& out)
+    {
+        out.reserve(list.size);
+        for (NodePtr node = list.head->next_; node && node != list.tail; node = node->next_)
+        {
+            out.emplace_back(node->getKey(), node->getValue());
+        }
+    }
+
+    static void copyGhost(const List& list, std::vector<Key>& out)
+    {
+        out.reserve(list.size);
+        for (NodePtr node = list.head->next_; node && node != list.tail; node = node->next_)
+        {
+            out.push_back(node->getKey());
+        }
+    }
+
+private:
+    size_t            capacity_; // 驻留数据总容量c，幽灵链表合计最多再记录c个key
+    size_t            p_;        // T1的目标大小
+    std::shared_mutex mutex_;
+    EntryMap          entries_;  // key -> 结点及其所在链表
+    List              lists_[SegmentCount];
+};
+
+} // namespace KamaCache
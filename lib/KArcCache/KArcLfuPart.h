@@ -1,9 +1,14 @@
 #pragma once
 
 #include "KArcCacheNode.h"
+#include "../KKeyRef.h"
 #include <unordered_map>
+#include <list>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
 
 namespace KamaCache 
 {
@@ -14,7 +19,7 @@ class ArcLfuPart
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = std::unordered_map<KeyRef<Key>, NodePtr>; // 主缓存与幽灵缓存的索引都引用结点内的key
     using FreqMap = std::map<size_t, std::list<NodePtr>>;
 
     explicit ArcLfuPart(size_t capacity, size_t transformThreshold)
@@ -31,8 +36,8 @@ public:
         if (capacity_ == 0) 
             return false;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = mainCache_.find(KeyRef<Key>(key));
         if (it != mainCache_.end()) 
         {
             return updateExistingNode(it->second, value);
@@ -42,8 +47,8 @@ public:
 
     bool get(Key key, Value& value) 
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = mainCache_.find(KeyRef<Key>(key));
         if (it != mainCache_.end()) 
         {
             updateNodeFrequency(it->second);
@@ -53,14 +58,45 @@ public:
         return false;
     }
 
+    // 只读查询：不增加访问频次
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = mainCache_.find(KeyRef<Key>(key));
+        if (it == mainCache_.end())
+            return false;
+        value = it->second->getValue();
+        return true;
+    }
+
     bool contain(Key key)
     {
-        return mainCache_.find(key) != mainCache_.end();
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return mainCache_.find(KeyRef<Key>(key)) != mainCache_.end();
+    }
+
+    // 拷贝出主缓存(频次从高到低，同频次最近加入的在前)与幽灵链表(最新淘汰的在前)
+    void snapshot(std::vector<std::pair<Key, Value>>& mainEntries, std::vector<Key>& ghostKeys)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        mainEntries.reserve(mainCache_.size());
+        for (auto freqIt = freqMap_.rbegin(); freqIt != freqMap_.rend(); ++freqIt)
+        {
+            for (auto it = freqIt->second.rbegin(); it != freqIt->second.rend(); ++it)
+            {
+                mainEntries.emplace_back((*it)->getKey(), (*it)->getValue());
+            }
+        }
+        ghostKeys.reserve(ghostCache_.size());
+        for (NodePtr node = ghostTail_->prev_.lock(); node && node != ghostHead_; node = node->prev_.lock())
+        {
+            ghostKeys.push_back(node->getKey());
+        }
     }
 
     bool checkGhost(Key key) 
     {
-        auto it = ghostCache_.find(key);
+        auto it = ghostCache_.find(KeyRef<Key>(key));
         if (it != ghostCache_.end()) 
         {
             removeFromGhost(it->second);
@@ -71,6 +107,27 @@ public:
     }
 
     void increaseCapacity() { ++capacity_; }
+
+    size_t capacity()
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    // 运行时调整容量：超出部分按频次从低到高移入幽灵缓存，幽灵缓存超出部分直接丢弃
+    void setCapacity(size_t capacity, size_t ghostCapacity)
+    {
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        capacity_ = capacity;
+        ghostCapacity_ = ghostCapacity;
+        while (mainCache_.size() > capacity_ && !freqMap_.empty())
+        {
+            minFreq_ = freqMap_.begin()->first;
+            evictLeastFrequent();
+        }
+        while (ghostCache_.size() > ghostCapacity_)
+            removeOldestGhost();
+    }
     
     bool decreaseCapacity() 
     {
@@ -107,7 +164,7 @@ private:
         }
 
         NodePtr newNode = std::make_shared<NodeType>(key, value);
-        mainCache_[key] = newNode;
+        mainCache_.emplace(KeyRef<Key>(newNode->getKey()), newNode);
         
         // 将新节点添加到频率为1的列表中
         if (freqMap_.find(1) == freqMap_.end()) 
@@ -179,7 +236,7 @@ private:
         addToGhost(leastNode);
         
         // 从主缓存中移除
-        mainCache_.erase(leastNode->getKey());
+        mainCache_.erase(KeyRef<Key>(leastNode->getKey()));
     }
 
     void removeFromGhost(NodePtr node) 
@@ -200,7 +257,7 @@ private:
             ghostTail_->prev_.lock()->next_ = node;
         }
         ghostTail_->prev_ = node;
-        ghostCache_[node->getKey()] = node;
+        ghostCache_.emplace(KeyRef<Key>(node->getKey()), node);
     }
 
     void removeOldestGhost() 
@@ -209,7 +266,7 @@ private:
         if (oldestGhost != ghostTail_) 
         {
             removeFromGhost(oldestGhost);
-            ghostCache_.erase(oldestGhost->getKey());
+            ghostCache_.erase(KeyRef<Key>(oldestGhost->getKey()));
         }
     }
 
@@ -218,7 +275,7 @@ private:
     size_t ghostCapacity_;
     size_t transformThreshold_;
     size_t minFreq_;
-    std::mutex mutex_;
+    std::shared_mutex mutex_;
 
     NodeMap mainCache_;
     NodeMap ghostCache_;
@@ -1,8 +1,13 @@
 #pragma once
 
 #include "KArcCacheNode.h"
+#include "../KKeyRef.h"
 #include <unordered_map>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <tuple>
+#include <vector>
 
 namespace KamaCache 
 {
@@ -13,7 +18,7 @@ class ArcLruPart
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = std::unordered_map<KeyRef<Key>, NodePtr>; // 主缓存与幽灵缓存的索引都引用结点内的key
 
     explicit ArcLruPart(size_t capacity, size_t transformThreshold)
         : capacity_(capacity)
@@ -27,8 +32,8 @@ public:
     {
         if (capacity_ == 0) return false;
         
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = mainCache_.find(KeyRef<Key>(key));
         if (it != mainCache_.end()) 
         {
             return updateExistingNode(it->second, value);
@@ -36,10 +41,29 @@ public:
         return addNewNode(key, value);
     }
 
+    // 批量导入，只加一次锁，输入顺序即访问顺序
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        if (capacity_ == 0) return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        for (; first != last; ++first)
+        {
+            const Key& key = std::get<0>(*first);
+            const Value& value = std::get<1>(*first);
+            auto it = mainCache_.find(KeyRef<Key>(key));
+            if (it != mainCache_.end())
+                updateExistingNode(it->second, value);
+            else
+                addNewNode(key, value);
+        }
+    }
+
     bool get(Key key, Value& value, bool& shouldTransform) 
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = mainCache_.find(KeyRef<Key>(key));
         if (it != mainCache_.end()) 
         {
             shouldTransform = updateNodeAccess(it->second);
@@ -49,9 +73,42 @@ public:
         return false;
     }
 
+    // 只读查询：不移动结点、不增加访问计数
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = mainCache_.find(KeyRef<Key>(key));
+        if (it == mainCache_.end())
+            return false;
+        value = it->second->getValue();
+        return true;
+    }
+
+    bool contain(Key key)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return mainCache_.find(KeyRef<Key>(key)) != mainCache_.end();
+    }
+
+    // 拷贝出主链表(MRU -> LRU)与幽灵链表(最新淘汰的在前)
+    void snapshot(std::vector<std::pair<Key, Value>>& mainEntries, std::vector<Key>& ghostKeys)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        mainEntries.reserve(mainCache_.size());
+        for (NodePtr node = mainHead_->next_; node && node != mainTail_; node = node->next_)
+        {
+            mainEntries.emplace_back(node->getKey(), node->getValue());
+        }
+        ghostKeys.reserve(ghostCache_.size());
+        for (NodePtr node = ghostHead_->next_; node && node != ghostTail_; node = node->next_)
+        {
+            ghostKeys.push_back(node->getKey());
+        }
+    }
+
     bool checkGhost(Key key) 
     {
-        auto it = ghostCache_.find(key);
+        auto it = ghostCache_.find(KeyRef<Key>(key));
         if (it != ghostCache_.end()) {
             removeFromGhost(it->second);
             ghostCache_.erase(it);
@@ -61,6 +118,24 @@ public:
     }
 
     void increaseCapacity() { ++capacity_; }
+
+    size_t capacity()
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    // 运行时调整容量：超出部分按LRU顺序移入幽灵缓存，幽灵缓存超出部分直接丢弃
+    void setCapacity(size_t capacity, size_t ghostCapacity)
+    {
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        capacity_ = capacity;
+        ghostCapacity_ = ghostCapacity;
+        while (mainCache_.size() > capacity_)
+            evictLeastRecent();
+        while (ghostCache_.size() > ghostCapacity_)
+            removeOldestGhost();
+    }
     
     bool decreaseCapacity() 
     {
@@ -101,7 +176,7 @@ private:
         }
 
         NodePtr newNode = std::make_shared<NodeType>(key, value);
-        mainCache_[key] = newNode;
+        mainCache_.emplace(KeyRef<Key>(newNode->getKey()), newNode);
         addToFront(newNode);
         return true;
     }
@@ -152,7 +227,7 @@ private:
         addToGhost(leastRecent);
 
         // 从主缓存映射中移除
-        mainCache_.erase(leastRecent->getKey());
+        mainCache_.erase(KeyRef<Key>(leastRecent->getKey()));
     }
 
     void removeFromMain(NodePtr node) 
@@ -187,7 +262,7 @@ private:
         ghostHead_->next_ = node;
         
         // 添加到幽灵缓存映射
-        ghostCache_[node->getKey()] = node;
+        ghostCache_.emplace(KeyRef<Key>(node->getKey()), node);
     }
 
     void removeOldestGhost() 
@@ -198,7 +273,7 @@ private:
             return;
 
         removeFromGhost(oldestGhost);
-        ghostCache_.erase(oldestGhost->getKey());
+        ghostCache_.erase(KeyRef<Key>(oldestGhost->getKey()));
     }
     
 
@@ -206,7 +281,7 @@ private:
     size_t capacity_;
     size_t ghostCapacity_;
     size_t transformThreshold_; // 转换门槛值
-    std::mutex mutex_;
+    std::shared_mutex mutex_;
 
     NodeMap mainCache_; // key -> ArcNode
     NodeMap ghostCache_;
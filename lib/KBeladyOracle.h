@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace KamaCache
+{
+
+struct BeladyResult
+{
+    size_t   hits = 0;
+    size_t   requests = 0;
+    uint64_t hitBytes = 0;
+    uint64_t requestBytes = 0;
+};
+
+// 离线最优(Belady MIN)模拟器：先用一次反向遍历算出每次访问的key下一次被访问的位置，
+// 再正向模拟，缺页时淘汰下一次访问最远的条目；若新key自己的下一次访问比所有驻留条目都远
+// (或再也不会被访问)，则直接不放入缓存。结果是同容量下任何在线策略命中率的上界，
+// 用来衡量LRU/LFU/ARC等策略离最优还有多少余地
+template<typename Key>
+class KBeladyOracle
+{
+public:
+    // sizes为空时每个条目大小视为1
+    explicit KBeladyOracle(std::vector<Key> trace, std::vector<uint64_t> sizes = {})
+        : trace_(std::move(trace))
+        , sizes_(std::move(sizes))
+    {
+        if (sizes_.size() != trace_.size())
+            sizes_.assign(trace_.size(), 1);
+        computeNextUse();
+    }
+
+    // 按条目数计容量的MIN，可证明最优
+    BeladyResult min(size_t capacity) const
+    {
+        BeladyResult result;
+        std::set<size_t> resident; // 驻留条目的下一次访问位置，rbegin为最远
+        for (size_t i = 0; i < trace_.size(); ++i)
+        {
+            countRequest(result, i);
+            size_t next = nextUse_[i];
+            if (resident.erase(i))
+            {
+                // 上一次访问记录的下一次访问位置正是i，说明该key驻留
+                countHit(result, i);
+                resident.insert(next);
+                continue;
+            }
+
+            if (capacity == 0 || next >= trace_.size())
+                continue;
+            if (resident.size() >= capacity)
+            {
+                auto farthest = std::prev(resident.end());
+                if (*farthest < next)
+                    continue;
+                resident.erase(farthest);
+            }
+            resident.insert(next);
+        }
+        return result;
+    }
+
+    // 按字节计容量的近似最优：缺页时只淘汰下一次访问比新条目更远的条目，
+    // 从最远的开始淘汰直到放得下，放不下则不放入。变长条目的精确最优是NP难问题，
+    // 这里采用常见的贪心做法，结果应按近似上界理解
+    BeladyResult minSize(uint64_t capacityBytes) const
+    {
+        BeladyResult result;
+        std::set<size_t> resident;
+        std::unordered_map<size_t, uint64_t> residentSize; // 下一次访问位置 -> 条目大小
+        uint64_t used = 0;
+        for (size_t i = 0; i < trace_.size(); ++i)
+        {
+            countRequest(result, i);
+            size_t next = nextUse_[i];
+            if (resident.erase(i))
+            {
+                countHit(result, i);
+                uint64_t size = residentSize[i];
+                residentSize.erase(i);
+                resident.insert(next);
+                residentSize[next] = size;
+                continue;
+            }
+
+            uint64_t size = sizes_[i];
+            if (size > capacityBytes || next >= trace_.size())
+                continue;
+
+            // 先确认只淘汰比新条目更远的条目就能放下
+            uint64_t freed = 0;
+            auto it = resident.rbegin();
+            while (used - freed + size > capacityBytes && it != resident.rend() && *it > next)
+            {
+                freed += residentSize[*it];
+                ++it;
+            }
+            if (used - freed + size > capacityBytes)
+                continue;
+
+            while (used + size > capacityBytes)
+            {
+                auto farthest = std::prev(resident.end());
+                used -= residentSize[*farthest];
+                residentSize.erase(*farthest);
+                resident.erase(farthest);
+            }
+            resident.insert(next);
+            residentSize[next] = size;
+            used += size;
+        }
+        return result;
+    }
+
+    size_t size() const { return trace_.size(); }
+
+private:
+    // 反向遍历一次：nextUse_[i]为trace_[i]下一次出现的位置；不再出现时取 trace_.size() + i，
+    // 既大于所有真实位置，又保证各条目互不相同，可以直接作为set中的唯一标识
+    void computeNextUse()
+    {
+        size_t n = trace_.size();
+        nextUse_.assign(n, 0);
+        std::unordered_map<Key, size_t> lastSeen;
+        lastSeen.reserve(n);
+        for (size_t i = n; i-- > 0;)
+        {
+            auto it = lastSeen.find(trace_[i]);
+            if (it == lastSeen.end())
+            {
+                nextUse_[i] = n + i;
+                lastSeen.emplace(trace_[i], i);
+            }
+            else
+            {
+                nextUse_[i] = it->second;
+                it->second = i;
+            }
+        }
+    }
+
+    void countRequest(BeladyResult& result, size_t i) const
+    {
+        ++result.requests;
+        result.requestBytes += sizes_[i];
+    }
+
+    void countHit(BeladyResult& result, size_t i) const
+    {
+        ++result.hits;
+        result.hitBytes += sizes_[i];
+    }
+
+private:
+    std::vector<Key>      trace_;
+    std::vector<uint64_t> sizes_;
+    std::vector<size_t>   nextUse_; // 每次访问对应key的下一次访问位置
+};
+
+} // namespace KamaCache
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace KamaCache
+{
+
+// 分片缓存的批量预热：先按key的哈希把输入划分到各分片(保持输入的相对顺序)，
+// 再由若干线程并行地调用各分片自身的bulkLoad，每个分片只加一次锁
+template<typename Slice, typename InputIt, typename HashFunc>
+void bulkLoadSlices(std::vector<std::unique_ptr<Slice>>& slices, InputIt first, InputIt last, HashFunc hash)
+{
+    using Item = typename std::iterator_traits<InputIt>::value_type;
+
+    size_t sliceNum = slices.size();
+    if (sliceNum == 0)
+        return;
+
+    std::vector<std::vector<Item>> parts(sliceNum);
+    for (; first != last; ++first)
+    {
+        parts[hash(std::get<0>(*first)) % sliceNum].push_back(*first);
+    }
+
+    size_t workerNum = std::min<size_t>(sliceNum, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < workerNum; ++w)
+    {
+        workers.emplace_back([&, w]() {
+            for (size_t i = w; i < sliceNum; i += workerNum)
+            {
+                if (!parts[i].empty())
+                    slices[i]->bulkLoad(parts[i].begin(), parts[i].end());
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+} // namespace KamaCache
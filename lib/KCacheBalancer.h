@@ -0,0 +1,350 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "KLockPolicy.h"
+#include "KLruCache.h"
+
+namespace KamaCache
+{
+
+// 影子统计的公共部分：访问/命中/幽灵命中/损失计数，由访问线程原子累加，平衡器每轮读取后清零
+class ShadowTrackerBase
+{
+public:
+    explicit ShadowTrackerBase(double sampleRate)
+        : sampleRate_(std::min(1.0, std::max(sampleRate, 1.0 / kSampleBuckets)))
+        , accesses_(0)
+        , hits_(0)
+        , ghostHits_(0)
+        , losses_(0)
+    {}
+
+    virtual ~ShadowTrackerBase() = default;
+
+    // 缓存容量为residentEntries时，影子需要再多记录ghostEntries个key才能判断幽灵命中，
+    // 内层影子少记录ghostEntries个key才能判断缩小同样空间会损失的命中
+    virtual void resize(size_t residentEntries, size_t ghostEntries) = 0;
+
+    double sampleRate() const { return sampleRate_; }
+
+protected:
+    static constexpr uint64_t kSampleBuckets = 1024;
+
+    double                sampleRate_;
+    std::atomic<uint64_t> accesses_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> ghostHits_; // 只统计被抽样的key
+    std::atomic<uint64_t> losses_;    // 只统计被抽样的key
+
+    friend class KCacheBalancer;
+};
+
+// 用一个只存key的LRU模拟"容量再大ghostEntries个条目"的缓存：
+// 真实缓存未命中而影子命中，说明多给这么多空间就能命中，记为一次幽灵命中。
+// 另一个只存key的内层LRU模拟"容量再小ghostEntries个条目"的缓存：
+// 真实缓存命中而内层影子未命中，说明命中落在栈底的ghostEntries个位置，缩小这么多空间就会失去，记为一次损失。
+// 对LRU这是精确的；对LFU/ARC等是按LRU栈距离的近似，用于比较各缓存增减空间的边际收益与损失。
+// sampleRate < 1时只跟踪hash落在抽样范围内的key(影子容量按比例缩小)，统计数再按比例放大
+template<typename Key>
+class ShadowTracker : public ShadowTrackerBase
+{
+public:
+    explicit ShadowTracker(double sampleRate = 1.0)
+        : ShadowTrackerBase(sampleRate)
+        , shadow_(1)
+        , inner_(1)
+        , threshold_(static_cast<uint64_t>(sampleRate_ * kSampleBuckets))
+    {}
+
+    // hit为真实缓存本次访问是否命中
+    void recordAccess(const Key& key, bool hit)
+    {
+        accesses_.fetch_add(1, std::memory_order_relaxed);
+        if (hit)
+            hits_.fetch_add(1, std::memory_order_relaxed);
+        if (!sampled(key))
+            return;
+
+        char marker;
+        bool inShadow = shadow_.get(key, marker);
+        if (!inShadow)
+            shadow_.put(key, 0);
+        bool inInner = inner_.get(key, marker);
+        if (!inInner)
+            inner_.put(key, 0);
+        if (!hit && inShadow)
+            ghostHits_.fetch_add(1, std::memory_order_relaxed);
+        if (hit && !inInner)
+            losses_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void resize(size_t residentEntries, size_t ghostEntries) override
+    {
+        double entries = (residentEntries + ghostEntries) * sampleRate_;
+        shadow_.setCapacity(std::max(1, static_cast<int>(entries + 0.5)));
+        double innerEntries = (residentEntries > ghostEntries ? residentEntries - ghostEntries : 0) * sampleRate_;
+        inner_.setCapacity(std::max(1, static_cast<int>(innerEntries + 0.5)));
+    }
+
+private:
+    bool sampled(const Key& key) const
+    {
+        // 先打散hash，避免整数key的恒等hash使抽样集中在某一段
+        uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9E3779B97F4A7C15ull;
+        return (h >> 54) < threshold_;
+    }
+
+private:
+    KLruCache<Key, char, KMutexLock> shadow_;    // 驻留 + ghostEntries个key
+    KLruCache<Key, char, KMutexLock> inner_;     // 驻留 - ghostEntries个key
+    uint64_t                         threshold_; // hash高10位小于该值的key被抽样
+};
+
+// 按驻留条目数设置缓存容量：缓存提供setResidentCapacity时优先使用(如Split模式的KArcCache，
+// setCapacity(n)最多驻留2n条)，否则认为setCapacity的参数就是驻留条目数
+template<typename Cache>
+auto setResidentCapacity(Cache& cache, size_t entries, int) -> decltype(cache.setResidentCapacity(entries), void())
+{
+    cache.setResidentCapacity(entries);
+}
+
+template<typename Cache>
+void setResidentCapacity(Cache& cache, size_t entries, long)
+{
+    cache.setCapacity(entries);
+}
+
+struct BalancerOptions
+{
+    size_t stepBytes = 1 << 20;      // 每轮最多从一个缓存移给另一个缓存的字节数，也是各缓存影子多跟踪的空间
+    double smoothing = 0.5;          // 每轮幽灵命中数与损失数的指数平滑系数，越大越看重最近一轮
+    double minGainRatio = 1.5;       // 接收方收益至少是捐出方损失的这么多倍才移动，防止来回抖动
+    std::chrono::milliseconds interval{1000}; // 后台平衡间隔
+};
+
+struct BalancerAllocation
+{
+    std::string name;
+    size_t      bytes = 0;
+    size_t      capacity = 0;  // 条目数
+    double      gain = 0;      // 平滑后的每轮幽灵命中数，即再多stepBytes每轮能多命中的次数
+    double      loss = 0;      // 平滑后的每轮损失数，即再少stepBytes每轮会少命中的次数
+    double      hitRate = 0;   // 最近一轮的命中率
+};
+
+// 全局内存平衡器：多个缓存共享固定的总字节预算，各缓存通过ShadowTracker上报访问，
+// 平衡器每轮找出"再多stepBytes能多命中最多"的缓存与"再少stepBytes少命中最少"的缓存，
+// 前者的收益明显大于后者的损失时把stepBytes从后者移给前者。
+// 每个缓存的影子都恰好多跟踪、内层影子恰好少跟踪stepBytes的空间，所以收益与损失可以直接按字节比较。
+// 收益与损失分开统计：工作集刚好装满的缓存多给空间没有收益，但缩小就会损失，不会被当成捐出方。
+// 注册时总预算在所有缓存间平均分配，应在启动阶段一次注册完所有缓存
+class KCacheBalancer
+{
+public:
+    using CapacitySetter = std::function<void(size_t)>;
+
+    explicit KCacheBalancer(size_t totalBytes, BalancerOptions options = BalancerOptions())
+        : totalBytes_(totalBytes)
+        , options_(options)
+        , running_(false)
+        , stop_(false)
+    {}
+
+    ~KCacheBalancer()
+    {
+        stop();
+    }
+
+    KCacheBalancer(const KCacheBalancer&) = delete;
+    KCacheBalancer& operator=(const KCacheBalancer&) = delete;
+
+    // bytesPerEntry为条目的平均占用；minBytes为该缓存至少保留的预算(不少于stepBytes)。
+    // 返回的ShadowTracker由平衡器持有，调用方每次访问缓存后调用recordAccess
+    template<typename Key>
+    ShadowTracker<Key>& registerCache(const std::string& name, size_t bytesPerEntry, CapacitySetter setCapacity,
+                                      size_t minBytes = 0, double sampleRate = 1.0)
+    {
+        auto tracker = std::make_unique<ShadowTracker<Key>>(sampleRate);
+        ShadowTracker<Key>& result = *tracker;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Account account;
+        account.name = name;
+        account.bytesPerEntry = std::max<size_t>(1, bytesPerEntry);
+        account.minBytes = minBytes;
+        account.setCapacity = std::move(setCapacity);
+        account.tracker = std::move(tracker);
+        accounts_.push_back(std::move(account));
+
+        size_t share = totalBytes_ / accounts_.size();
+        for (Account& existing : accounts_)
+        {
+            existing.bytes = share;
+            existing.gain = 0;
+            existing.loss = 0;
+            apply(existing);
+        }
+        return result;
+    }
+
+    // 预算换算成驻留条目数后交给缓存，见setResidentCapacity
+    template<typename Key, typename Cache>
+    ShadowTracker<Key>& registerCache(const std::string& name, Cache& cache, size_t bytesPerEntry,
+                                      size_t minBytes = 0, double sampleRate = 1.0)
+    {
+        return registerCache<Key>(name, bytesPerEntry,
+                                  [&cache](size_t entries) { setResidentCapacity(cache, entries, 0); },
+                                  minBytes, sampleRate);
+    }
+
+    // 执行一轮：更新各缓存的边际收益，必要时移动一步预算。不启动后台线程时可由调用方自行驱动
+    void rebalance()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (accounts_.size() < 2)
+            return;
+
+        for (Account& account : accounts_)
+        {
+            ShadowTrackerBase& tracker = *account.tracker;
+            uint64_t accesses = tracker.accesses_.exchange(0, std::memory_order_relaxed);
+            uint64_t hits = tracker.hits_.exchange(0, std::memory_order_relaxed);
+            double ghostHits = tracker.ghostHits_.exchange(0, std::memory_order_relaxed) / tracker.sampleRate();
+            double losses = tracker.losses_.exchange(0, std::memory_order_relaxed) / tracker.sampleRate();
+            account.hitRate = accesses == 0 ? 0.0 : static_cast<double>(hits) / accesses;
+            account.gain = options_.smoothing * ghostHits + (1.0 - options_.smoothing) * account.gain;
+            account.loss = options_.smoothing * losses + (1.0 - options_.smoothing) * account.loss;
+        }
+
+        Account* receiver = nullptr;
+        Account* donor = nullptr;
+        for (Account& account : accounts_)
+        {
+            if (!receiver || account.gain > receiver->gain)
+                receiver = &account;
+        }
+        for (Account& account : accounts_)
+        {
+            // 每个缓存至少保留一步的预算
+            size_t floor = std::max(account.minBytes, options_.stepBytes);
+            if (&account == receiver || account.bytes < floor + options_.stepBytes)
+                continue;
+            if (!donor || account.loss < donor->loss)
+                donor = &account;
+        }
+
+        if (!donor || receiver->gain <= 0 || receiver->gain < donor->loss * options_.minGainRatio)
+            return;
+        donor->bytes -= options_.stepBytes;
+        receiver->bytes += options_.stepBytes;
+        apply(*donor);
+        apply(*receiver);
+    }
+
+    // 启动后台线程，按interval周期调用rebalance
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_)
+            return;
+        running_ = true;
+        stop_ = false;
+        worker_ = std::thread([this] { run(); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+                return;
+            stop_ = true;
+        }
+        wakeup_.notify_one();
+        worker_.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+
+    std::vector<BalancerAllocation> allocations()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<BalancerAllocation> result;
+        result.reserve(accounts_.size());
+        for (const Account& account : accounts_)
+        {
+            BalancerAllocation allocation;
+            allocation.name = account.name;
+            allocation.bytes = account.bytes;
+            allocation.capacity = capacityOf(account);
+            allocation.gain = account.gain;
+            allocation.loss = account.loss;
+            allocation.hitRate = account.hitRate;
+            result.push_back(std::move(allocation));
+        }
+        return result;
+    }
+
+private:
+    struct Account
+    {
+        std::string                        name;
+        size_t                             bytesPerEntry = 1;
+        size_t                             minBytes = 0;
+        size_t                             bytes = 0;
+        double                             gain = 0;
+        double                             loss = 0;
+        double                             hitRate = 0;
+        CapacitySetter                     setCapacity;
+        std::unique_ptr<ShadowTrackerBase> tracker;
+    };
+
+    size_t capacityOf(const Account& account) const
+    {
+        return std::max<size_t>(1, account.bytes / account.bytesPerEntry);
+    }
+
+    // 调用方需持有mutex_
+    void apply(Account& account)
+    {
+        size_t capacity = capacityOf(account);
+        account.setCapacity(capacity);
+        account.tracker->resize(capacity, std::max<size_t>(1, options_.stepBytes / account.bytesPerEntry));
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_)
+        {
+            lock.unlock();
+            rebalance();
+            lock.lock();
+            wakeup_.wait_for(lock, options_.interval, [this] { return stop_; });
+        }
+    }
+
+private:
+    size_t                  totalBytes_;
+    BalancerOptions         options_;
+    bool                    running_;
+    bool                    stop_;
+    std::mutex              mutex_;    // 保护accounts_与以上状态；容量回调在锁内调用
+    std::vector<Account>    accounts_;
+    std::condition_variable wakeup_;
+    std::thread             worker_;
+};
+
+} // namespace KamaCache
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace KamaCache
+{
+
+// 把一份已拷贝出的快照按不超过chunkSize的块依次交给回调fn(const std::vector<Entry>&)。
+// 快照在加锁期间拷贝完成，回调执行时不持有任何缓存锁
+template<typename Entry, typename Fn>
+void streamInChunks(std::vector<Entry>&& entries, size_t chunkSize, Fn& fn)
+{
+    if (chunkSize == 0)
+        chunkSize = 1;
+
+    std::vector<Entry> chunk;
+    chunk.reserve(std::min(chunkSize, entries.size()));
+    for (auto& entry : entries)
+    {
+        chunk.push_back(std::move(entry));
+        if (chunk.size() == chunkSize)
+        {
+            fn(chunk);
+            chunk.clear();
+        }
+    }
+    if (!chunk.empty())
+        fn(chunk);
+}
+
+} // namespace KamaCache
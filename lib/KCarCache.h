@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "KICachePolicy.h"
+#include "KKeyRef.h"
+
+namespace KamaCache
+{
+
+// CAR (Clock with Adaptive Replacement, Bansal & Modha)：
+// 保留ARC的自适应目标p与B1/B2幽灵链表，但驻留数据放在两个CLOCK(T1/T2)中，
+// 每个结点只有一个引用位。命中时只需共享加锁并以relaxed方式置位引用位，
+// 不需要移动链表结点；只有未命中(put新key/幽灵命中)才需要独占加锁
+template<typename Key, typename Value>
+class KCarCache : public KICachePolicy<Key, Value>
+{
+private:
+    enum Segment { T1 = 0, T2, B1, B2, SegmentCount };
+
+    struct Node
+    {
+        Key                                key;
+        Value                              value;
+        std::atomic<bool>                  referenced;
+        Segment                            segment;
+        bool                               adapted; // 幽灵命中时已在get中调整过p
+        typename std::list<Node*>::iterator pos;    // 在所属链表中的位置
+
+        Node(const Key& k, const Value& v)
+            : key(k), value(v), referenced(false), segment(T1), adapted(false)
+        {}
+    };
+
+    using NodeMap = std::unordered_map<KeyRef<Key>, std::unique_ptr<Node>>;
+
+public:
+    explicit KCarCache(size_t capacity)
+        : capacity_(capacity)
+        , p_(0)
+    {}
+
+    ~KCarCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end() && isResident(it->second.get()))
+        {
+            it->second->value = value;
+            it->second->referenced.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        Node* ghost = it != nodeMap_.end() ? it->second.get() : nullptr;
+        if (lists_[T1].size() + lists_[T2].size() >= capacity_)
+        {
+            replace();
+            // 目录替换：保证T1+B1不超过c，四个链表合计不超过2c
+            if (!ghost && lists_[T1].size() + lists_[B1].size() >= capacity_)
+                discardLeastRecent(B1);
+            else if (!ghost && totalSize() >= 2 * capacity_)
+                discardLeastRecent(B2);
+        }
+
+        if (!ghost)
+        {
+            auto node = std::make_unique<Node>(key, value);
+            Node* raw = node.get();
+            raw->pos = lists_[T1].insert(lists_[T1].end(), raw);
+            nodeMap_.emplace(KeyRef<Key>(raw->key), std::move(node));
+            return;
+        }
+
+        if (!ghost->adapted)
+            adapt(ghost->segment);
+        ghost->adapted = false;
+        ghost->value = value;
+        ghost->referenced.store(false, std::memory_order_relaxed);
+        moveToTail(ghost, T2);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = nodeMap_.find(KeyRef<Key>(key));
+            if (it == nodeMap_.end())
+                return false;
+            Node* node = it->second.get();
+            if (isResident(node))
+            {
+                // 命中只置位引用位，不移动结点
+                node->referenced.store(true, std::memory_order_relaxed);
+                value = node->value;
+                return true;
+            }
+        }
+
+        // 幽灵命中：独占加锁后根据命中的幽灵链表调整p
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end() && !isResident(it->second.get()) && !it->second->adapted)
+        {
+            adapt(it->second->segment);
+            it->second->adapted = true;
+        }
+        return false;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只读查询：不置位引用位
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it == nodeMap_.end() || !isResident(it->second.get()))
+            return false;
+        value = it->second->value;
+        return true;
+    }
+
+    bool contains(Key key)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        return it != nodeMap_.end() && isResident(it->second.get());
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+private:
+    // CLOCK替换：在T1或T2上转动指针，把遇到的引用位清零，直到找到引用位为0的结点降级为幽灵
+    void replace()
+    {
+        while (true)
+        {
+            if (!lists_[T1].empty() && lists_[T1].size() >= std::max<size_t>(1, p_))
+            {
+                Node* head = lists_[T1].front();
+                if (!head->referenced.load(std::memory_order_relaxed))
+                {
+                    demote(head, B1);
+                    return;
+                }
+                // T1中被再次访问过的结点转入T2
+                head->referenced.store(false, std::memory_order_relaxed);
+                moveToTail(head, T2);
+            }
+            else if (!lists_[T2].empty())
+            {
+                Node* head = lists_[T2].front();
+                if (!head->referenced.load(std::memory_order_relaxed))
+                {
+                    demote(head, B2);
+                    return;
+                }
+                head->referenced.store(false, std::memory_order_relaxed);
+                moveToTail(head, T2);
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    void adapt(Segment ghost)
+    {
+        size_t b1 = lists_[B1].size();
+        size_t b2 = lists_[B2].size();
+        if (ghost == B1)
+        {
+            size_t delta = b1 == 0 ? 1 : std::max<size_t>(1, b2 / b1);
+            p_ = std::min(p_ + delta, capacity_);
+        }
+        else
+        {
+            size_t delta = b2 == 0 ? 1 : std::max<size_t>(1, b1 / b2);
+            p_ = p_ > delta ? p_ - delta : 0;
+        }
+    }
+
+    // 驻留结点降级到幽灵链表的MRU端(front)，释放其value
+    void demote(Node* node, Segment ghost)
+    {
+        lists_[node->segment].erase(node->pos);
+        node->pos = lists_[ghost].insert(lists_[ghost].begin(), node);
+        node->segment = ghost;
+        node->value = Value();
+        node->adapted = false;
+    }
+
+    // 移动到CLOCK(T1/T2)的尾部，即指针最晚扫到的位置
+    void moveToTail(Node* node, Segment segment)
+    {
+        lists_[node->segment].erase(node->pos);
+        node->pos = lists_[segment].insert(lists_[segment].end(), node);
+        node->segment = segment;
+    }
+
+    void discardLeastRecent(Segment ghost)
+    {
+        if (lists_[ghost].empty())
+            return;
+        Node* node = lists_[ghost].back();
+        lists_[ghost].pop_back();
+        // 先按key找到迭代器再删除，避免用即将被销毁的结点内的key作为删除参数
+        auto it = nodeMap_.find(KeyRef<Key>(node->key));
+        nodeMap_.erase(it);
+    }
+
+    size_t totalSize() const
+    {
+        return lists_[T1].size() + lists_[T2].size() + lists_[B1].size() + lists_[B2].size();
+    }
+
+    static bool isResident(const Node* node)
+    {
+        return node->segment == T1 || node->segment == T2;
+    }
+
+private:
+    size_t            capacity_; // 驻留数据容量c
+    size_t            p_;        // T1的目标大小
+    std::shared_mutex mutex_;    // 命中共享加锁，未命中独占加锁
+    NodeMap           nodeMap_;  // key -> 结点(驻留或幽灵)
+    std::list<Node*>  lists_[SegmentCount]; // T1/T2: front为时钟指针处；B1/B2: front为MRU
+};
+
+} // namespace KamaCache
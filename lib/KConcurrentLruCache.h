@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "KICachePolicy.h"
+#include "KKeyRef.h"
+
+namespace KamaCache
+{
+
+// 索引锁与链表锁分离的LRU：
+// 索引按key的hash分成若干条带，每个条带有自己的读写锁；LRU链表单独使用一把互斥锁，只负责维护访问顺序。
+// 命中时只共享加锁所在条带，再tryLock链表锁把结点移到MRU端，链表锁被占用时不等待，
+// 只给结点打上"被访问过"的标记，淘汰扫到该结点时给它第二次机会(移回MRU端)。
+// 淘汰在所有条带锁之外进行：先在链表锁内摘下LRU结点，再单独加锁所在条带删除索引，
+// 因此查询不会排在淘汰后面，也不会被其他条带上的淘汰阻塞。
+// 加锁顺序固定为 条带锁 -> 链表锁，淘汰时不会同时持有二者的反向顺序
+template<typename Key, typename Value>
+class KConcurrentLruCache : public KICachePolicy<Key, Value>
+{
+private:
+    struct Node
+    {
+        Key               key;
+        Value             value;   // 由所在条带的锁保护
+        Node*             prev;    // 以下三项由链表锁保护
+        Node*             next;
+        bool              linked;
+        std::atomic<bool> touched; // 命中时没拿到链表锁，推迟的一次提升
+
+        Node(const Key& k, const Value& v)
+            : key(k), value(v), prev(nullptr), next(nullptr), linked(false), touched(false)
+        {}
+    };
+
+    using NodeMap = std::unordered_map<KeyRef<Key>, std::unique_ptr<Node>>;
+
+    struct alignas(64) Stripe
+    {
+        std::shared_mutex mutex;
+        NodeMap           nodes;
+    };
+
+public:
+    explicit KConcurrentLruCache(size_t capacity, size_t stripeNum = 16)
+        : capacity_(capacity)
+        , size_(0)
+        , stripes_(std::max<size_t>(1, stripeNum))
+        , head_(Key(), Value())
+        , tail_(Key(), Value())
+    {
+        head_.next = &tail_;
+        tail_.prev = &head_;
+    }
+
+    ~KConcurrentLruCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        Stripe& stripe = stripeFor(key);
+        {
+            std::lock_guard<std::shared_mutex> lock(stripe.mutex);
+            auto it = stripe.nodes.find(KeyRef<Key>(key));
+            if (it != stripe.nodes.end())
+            {
+                Node* node = it->second.get();
+                node->value = value;
+                std::lock_guard<std::mutex> listLock(listMutex_);
+                if (!node->linked)
+                {
+                    // 已被淘汰线程摘下但索引尚未删除，重新挂回链表使其存活；
+                    // 结点数因此加一，同样需要在下面淘汰，否则停止写入后会一直超出容量
+                    size_.fetch_add(1, std::memory_order_relaxed);
+                }
+                moveToFront(node);
+            }
+            else
+            {
+                auto node = std::make_unique<Node>(key, value);
+                Node* raw = node.get();
+                stripe.nodes.emplace(KeyRef<Key>(raw->key), std::move(node));
+                // 在条带锁内挂入链表，remove/淘汰看到索引中的结点时它一定已在链表中
+                std::lock_guard<std::mutex> listLock(listMutex_);
+                moveToFront(raw);
+                size_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // 超出容量的部分在条带锁之外淘汰
+        while (size_.load(std::memory_order_relaxed) > capacity_ && evictOne())
+        {
+        }
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        Stripe& stripe = stripeFor(key);
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        auto it = stripe.nodes.find(KeyRef<Key>(key));
+        if (it == stripe.nodes.end())
+            return false;
+
+        Node* node = it->second.get();
+        value = node->value;
+
+        std::unique_lock<std::mutex> listLock(listMutex_, std::try_to_lock);
+        if (listLock.owns_lock())
+        {
+            if (node->linked)
+                moveToFront(node);
+        }
+        else
+        {
+            node->touched.store(true, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只读查询：不调整LRU顺序，不碰链表锁
+    bool peek(Key key, Value& value)
+    {
+        Stripe& stripe = stripeFor(key);
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        auto it = stripe.nodes.find(KeyRef<Key>(key));
+        if (it == stripe.nodes.end())
+            return false;
+        value = it->second->value;
+        return true;
+    }
+
+    bool contains(Key key)
+    {
+        Stripe& stripe = stripeFor(key);
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        return stripe.nodes.find(KeyRef<Key>(key)) != stripe.nodes.end();
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+    void remove(Key key)
+    {
+        Stripe& stripe = stripeFor(key);
+        std::lock_guard<std::shared_mutex> lock(stripe.mutex);
+        auto it = stripe.nodes.find(KeyRef<Key>(key));
+        if (it == stripe.nodes.end())
+            return;
+        {
+            std::lock_guard<std::mutex> listLock(listMutex_);
+            if (it->second->linked)
+            {
+                unlink(it->second.get());
+                size_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        stripe.nodes.erase(it);
+    }
+
+    size_t size() const
+    {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+private:
+    Stripe& stripeFor(const Key& key)
+    {
+        return stripes_[std::hash<Key>{}(key) % stripes_.size()];
+    }
+
+    // 在链表锁内摘下一个LRU结点，释放链表锁后再到所在条带删除索引。返回false表示没有可淘汰的结点
+    bool evictOne()
+    {
+        Node* victim = nullptr;
+        Key victimKey;
+        {
+            std::lock_guard<std::mutex> listLock(listMutex_);
+            if (size_.load(std::memory_order_relaxed) <= capacity_)
+                return false;
+
+            // 推迟提升的结点获得第二次机会，最多扫描一轮，避免全部被标记时无限循环
+            size_t budget = size_.load(std::memory_order_relaxed);
+            Node* node = tail_.prev;
+            while (node != &head_ && budget-- > 0 && node->touched.exchange(false, std::memory_order_relaxed))
+            {
+                moveToFront(node);
+                node = tail_.prev;
+            }
+            if (node == &head_)
+                return false;
+
+            unlink(node);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            victim = node;
+            victimKey = node->key;
+        }
+
+        // 摘下后结点仍归索引所有，只有这里或remove会释放它
+        Stripe& stripe = stripeFor(victimKey);
+        std::lock_guard<std::shared_mutex> lock(stripe.mutex);
+        auto it = stripe.nodes.find(KeyRef<Key>(victimKey));
+        if (it == stripe.nodes.end() || it->second.get() != victim)
+            return true;
+
+        std::lock_guard<std::mutex> listLock(listMutex_);
+        // 摘下后、删除前被put重新挂回链表的结点保留
+        if (!victim->linked)
+            stripe.nodes.erase(it);
+        return true;
+    }
+
+    void unlink(Node* node)
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = nullptr;
+        node->next = nullptr;
+        node->linked = false;
+    }
+
+    // 挂到MRU端(head一侧)，已在链表中的结点先摘下
+    void moveToFront(Node* node)
+    {
+        if (node->linked)
+            unlink(node);
+        node->next = head_.next;
+        node->prev = &head_;
+        head_.next->prev = node;
+        head_.next = node;
+        node->linked = true;
+    }
+
+private:
+    size_t              capacity_;
+    std::atomic<size_t> size_;       // 链表中的结点数
+    std::vector<Stripe> stripes_;    // 按key的hash分条带的索引
+    std::mutex          listMutex_;  // 只保护LRU链表
+    Node                head_;       // 虚拟头结点，head一侧为MRU
+    Node                tail_;       // 虚拟尾结点
+};
+
+} // namespace KamaCache
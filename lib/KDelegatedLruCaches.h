@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "KLruCache.h"
+#include "KMpscQueue.h"
+
+namespace KamaCache
+{
+
+// 每个分片独占一个工作线程(shared-nothing)：分片中的LRU只被它自己的线程访问(使用空锁)，
+// 其他线程不加锁，而是把请求投递到该分片的无锁MPSC队列中，结果通过future或回调返回。
+// 批量接口按分片把key分组，每个分片只投递一个请求。
+// 与KHashLruCaches相比，分片数据结构始终留在同一个核心的缓存中，代价是每个请求多一次线程间传递。
+// 请求执行中抛出的异常(如拷贝Value失败)通过对应的future交给调用方，不会终止分片线程
+template<typename Key, typename Value>
+class KDelegatedLruCaches
+{
+private:
+    using Slice = KLruCache<Key, Value, KNullLock>; // 分片只被自己的线程访问，不需要加锁
+    using Task = std::function<void(Slice&)>;
+
+    struct Shard
+    {
+        std::unique_ptr<Slice>  slice;
+        KMpscQueue<Task>        queue;
+        std::thread             worker;
+        std::atomic<bool>       sleeping{false};
+        std::mutex              sleepMutex;
+        std::condition_variable wakeup;
+
+        Shard(size_t sliceSize, size_t queueCapacity)
+            : slice(std::make_unique<Slice>(static_cast<int>(sliceSize)))
+            , queue(queueCapacity)
+        {}
+    };
+
+public:
+    // pinThreads: 在Linux上把第i个分片线程绑定到第i个CPU上
+    KDelegatedLruCaches(size_t capacity, int shardNum = 0, size_t queueCapacity = 1024, bool pinThreads = false)
+        : shardNum_(shardNum > 0 ? shardNum : std::max(1u, std::thread::hardware_concurrency()))
+        , stop_(false)
+    {
+        size_t sliceSize = std::ceil(capacity / static_cast<double>(shardNum_));
+        for (int i = 0; i < shardNum_; ++i)
+            shards_.emplace_back(std::make_unique<Shard>(sliceSize, queueCapacity));
+        for (int i = 0; i < shardNum_; ++i)
+        {
+            shards_[i]->worker = std::thread([this, i] { run(*shards_[i]); });
+            if (pinThreads)
+                pinToCpu(shards_[i]->worker, i);
+        }
+    }
+
+    ~KDelegatedLruCaches()
+    {
+        stop_.store(true);
+        for (auto& shard : shards_)
+        {
+            {
+                std::lock_guard<std::mutex> lock(shard->sleepMutex);
+            }
+            shard->wakeup.notify_one();
+            shard->worker.join();
+        }
+    }
+
+    KDelegatedLruCaches(const KDelegatedLruCaches&) = delete;
+    KDelegatedLruCaches& operator=(const KDelegatedLruCaches&) = delete;
+
+    std::future<void> putAsync(Key key, Value value)
+    {
+        auto promise = std::make_shared<std::promise<void>>();
+        std::future<void> future = promise->get_future();
+        size_t index = shardIndex(key); // 先算分片，key随后会被移入lambda
+        submit(index, [promise, key = std::move(key), value = std::move(value)](Slice& slice) {
+            try
+            {
+                slice.put(key, value);
+                promise->set_value();
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+
+    std::future<std::optional<Value>> getAsync(Key key)
+    {
+        auto promise = std::make_shared<std::promise<std::optional<Value>>>();
+        std::future<std::optional<Value>> future = promise->get_future();
+        size_t index = shardIndex(key);
+        submit(index, [promise, key = std::move(key)](Slice& slice) {
+            try
+            {
+                Value value{};
+                if (slice.get(key, value))
+                    promise->set_value(std::move(value));
+                else
+                    promise->set_value(std::nullopt);
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+
+    // 回调版本：callback在分片线程上执行，不应做耗时操作。
+    // 查询本身失败时按未命中回调；callback抛出的异常由分片线程丢弃，调用方无从得知，应在callback内自行处理
+    void getAsync(Key key, std::function<void(std::optional<Value>)> callback)
+    {
+        size_t index = shardIndex(key);
+        submit(index, [callback = std::move(callback), key = std::move(key)](Slice& slice) {
+            std::optional<Value> result;
+            try
+            {
+                Value value{};
+                if (slice.get(key, value))
+                    result = std::move(value);
+            }
+            catch (...)
+            {
+                result = std::nullopt;
+            }
+            callback(std::move(result));
+        });
+    }
+
+    void put(Key key, Value value)
+    {
+        putAsync(std::move(key), std::move(value)).get();
+    }
+
+    bool get(Key key, Value& value)
+    {
+        std::optional<Value> result = getAsync(std::move(key)).get();
+        if (!result)
+            return false;
+        value = std::move(*result);
+        return true;
+    }
+
+    // 批量查询：按分片分组后每个分片只投递一次，结果与keys一一对应。
+    // 某个分片失败时等所有分片结束后抛出第一个异常
+    std::vector<std::optional<Value>> getBatch(const std::vector<Key>& keys)
+    {
+        std::vector<std::optional<Value>> results(keys.size());
+        std::vector<std::vector<size_t>> groups(shardNum_);
+        for (size_t i = 0; i < keys.size(); ++i)
+            groups[shardIndex(keys[i])].push_back(i);
+
+        std::vector<std::future<void>> pending;
+        for (int s = 0; s < shardNum_; ++s)
+        {
+            if (groups[s].empty())
+                continue;
+            auto promise = std::make_shared<std::promise<void>>();
+            pending.push_back(promise->get_future());
+            // 各分片写入results中互不重叠的位置，调用方在所有future就绪前不会返回
+            submit(s, [promise, &keys, &results, positions = std::move(groups[s])](Slice& slice) {
+                try
+                {
+                    for (size_t pos : positions)
+                    {
+                        Value value{};
+                        if (slice.get(keys[pos], value))
+                            results[pos] = std::move(value);
+                    }
+                    promise->set_value();
+                }
+                catch (...)
+                {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+        waitAll(pending);
+        return results;
+    }
+
+    // 批量写入：按分片分组后每个分片只投递一次，返回时全部写入已完成。
+    // 某个分片失败时该分片中失败之前的写入已生效，等所有分片结束后抛出第一个异常
+    void putBatch(const std::vector<std::pair<Key, Value>>& items)
+    {
+        std::vector<std::vector<size_t>> groups(shardNum_);
+        for (size_t i = 0; i < items.size(); ++i)
+            groups[shardIndex(items[i].first)].push_back(i);
+
+        std::vector<std::future<void>> pending;
+        for (int s = 0; s < shardNum_; ++s)
+        {
+            if (groups[s].empty())
+                continue;
+            auto promise = std::make_shared<std::promise<void>>();
+            pending.push_back(promise->get_future());
+            submit(s, [promise, &items, positions = std::move(groups[s])](Slice& slice) {
+                try
+                {
+                    for (size_t pos : positions)
+                        slice.put(items[pos].first, items[pos].second);
+                    promise->set_value();
+                }
+                catch (...)
+                {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+        waitAll(pending);
+    }
+
+private:
+    size_t shardIndex(const Key& key) const
+    {
+        return std::hash<Key>{}(key) % shardNum_;
+    }
+
+    // 批量请求的任务引用调用方的keys/results，必须等所有分片都结束后才能抛出异常
+    static void waitAll(std::vector<std::future<void>>& pending)
+    {
+        std::exception_ptr error;
+        for (auto& future : pending)
+        {
+            try
+            {
+                future.get();
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // 队列满时让出CPU后重试；投递后若分片线程在睡眠则唤醒它
+    void submit(size_t index, Task task)
+    {
+        Shard& shard = *shards_[index];
+        while (!shard.queue.tryPush(std::move(task)))
+            std::this_thread::yield();
+
+        // 与run中设置sleeping后再检查队列配对，避免丢失唤醒
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (shard.sleeping.load(std::memory_order_relaxed))
+        {
+            {
+                std::lock_guard<std::mutex> lock(shard.sleepMutex);
+            }
+            shard.wakeup.notify_one();
+        }
+    }
+
+    // 分片线程：批量取出请求并执行；空闲一段时间后睡眠，等待投递方唤醒
+    void run(Shard& shard)
+    {
+        Task task;
+        int idle = 0;
+        while (true)
+        {
+            if (shard.queue.tryPop(task))
+            {
+                try
+                {
+                    task(*shard.slice);
+                }
+                catch (...)
+                {
+                    // 各请求已把异常交给自己的promise，这里只会收到回调抛出的异常，丢弃以保住分片线程
+                }
+                task = nullptr;
+                idle = 0;
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire))
+                break;
+            if (++idle < kSpinBeforeSleep)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(shard.sleepMutex);
+            shard.sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // 超时只是兜底，正常情况下由submit唤醒
+            shard.wakeup.wait_for(lock, std::chrono::milliseconds(10),
+                [&] { return !shard.queue.empty() || stop_.load(std::memory_order_acquire); });
+            shard.sleeping.store(false, std::memory_order_relaxed);
+            idle = 0;
+        }
+    }
+
+    static void pinToCpu(std::thread& thread, int index)
+    {
+#ifdef __linux__
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)index;
+#endif
+    }
+
+private:
+    static constexpr int kSpinBeforeSleep = 64;
+
+    int                                 shardNum_;
+    std::atomic<bool>                   stop_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace KamaCache
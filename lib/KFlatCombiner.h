@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace KamaCache
+{
+
+// 平面合并(flat combining)：线程不直接争抢锁，而是把操作发布到一个发布槽中；
+// 抢到锁的线程(合并者)一次性执行所有槽中待处理的操作，其余线程只需等待自己的槽被标记为完成。
+// 锁只在合并者之间交接，被保护的数据结构在一段时间内只被一个核心访问，缓存局部性更好。
+// 代价是每个操作多一次发布与等待：竞争不激烈(例如每个分片只有几个线程)时通常比直接加锁更慢，
+// 只有大量线程同时争抢同一把锁时才可能占优。
+// 操作以指针形式发布，不分配内存；操作抛出的异常会被转交回发布它的线程
+class FlatCombiner
+{
+private:
+    enum State { Empty = 0, Pending, Done };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<bool> owned{false};
+        std::atomic<int>  state{Empty};
+        void            (*fn)(void*) = nullptr;
+        void*             arg = nullptr;
+        std::exception_ptr error;
+    };
+
+public:
+    explicit FlatCombiner(size_t slotNum = 0)
+        : slots_(slotNum > 0 ? slotNum : std::max<size_t>(8, 2 * std::thread::hardware_concurrency()))
+    {}
+
+    FlatCombiner(const FlatCombiner&) = delete;
+    FlatCombiner& operator=(const FlatCombiner&) = delete;
+
+    // 发布op并等待其执行完成；op可能由其他线程执行，返回时op的所有副作用都已可见
+    template<typename Op>
+    void execute(Op& op)
+    {
+        Slot& slot = acquireSlot();
+        slot.fn = [](void* p) { (*static_cast<Op*>(p))(); };
+        slot.arg = &op;
+        slot.state.store(Pending, std::memory_order_release);
+
+        while (slot.state.load(std::memory_order_acquire) != Done)
+        {
+            if (mutex_.try_lock())
+            {
+                combine();
+                mutex_.unlock();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        std::exception_ptr error = std::move(slot.error);
+        slot.error = nullptr;
+        slot.state.store(Empty, std::memory_order_relaxed);
+        slot.owned.store(false, std::memory_order_release);
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    // 优先使用本线程固定对应的槽，被占用时依次尝试后面的槽
+    Slot& acquireSlot()
+    {
+        static std::atomic<size_t> nextThreadId{0};
+        static thread_local size_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+
+        size_t start = threadId % slots_.size();
+        for (size_t i = start;; i = (i + 1) % slots_.size())
+        {
+            Slot& slot = slots_[i];
+            bool expected = false;
+            if (!slot.owned.load(std::memory_order_relaxed)
+                && slot.owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return slot;
+            if ((i + 1) % slots_.size() == start)
+                std::this_thread::yield();
+        }
+    }
+
+    // 持锁扫描所有槽，执行待处理的操作；多扫几轮以顺带处理扫描期间新发布的操作
+    void combine()
+    {
+        for (int pass = 0; pass < kCombinePasses; ++pass)
+        {
+            bool found = false;
+            for (Slot& slot : slots_)
+            {
+                if (slot.state.load(std::memory_order_acquire) != Pending)
+                    continue;
+                found = true;
+                try
+                {
+                    slot.fn(slot.arg);
+                }
+                catch (...)
+                {
+                    slot.error = std::current_exception();
+                }
+                slot.state.store(Done, std::memory_order_release);
+            }
+            if (!found)
+                break;
+        }
+    }
+
+private:
+    static constexpr int kCombinePasses = 3;
+
+    std::vector<Slot> slots_;
+    std::mutex        mutex_; // 合并者锁
+};
+
+} // namespace KamaCache
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace KamaCache
+{
+
+// Disabled    - 普通4KB页(显式MADV_NOHUGEPAGE，便于对比)
+// Transparent - 2MB对齐映射后madvise(MADV_HUGEPAGE)，由内核用透明大页回填
+// HugeTlb     - 先尝试MAP_HUGETLB使用预留的大页，没有预留或不支持时退回Transparent
+enum class HugePageMode
+{
+    Disabled,
+    Transparent,
+    HugeTlb
+};
+
+struct ArenaStats
+{
+    size_t mappedBytes = 0;   // 已映射的字节数(含大块分配)
+    size_t hugeTlbBytes = 0;  // 其中由MAP_HUGETLB映射的字节数
+    size_t liveBytes = 0;     // 当前已分配未释放的字节数
+};
+
+// 结点内存池：从2MB对齐的大块中顺序切分对象，释放的对象按大小类挂在空闲链表上复用。
+// 不超过4KB的按16字节分类，4KB到1MB之间(如哈希表的桶数组)按2的幂分类，同样从大块中切分；
+// 只有超过1MB的分配单独映射。池分成若干个分配槽，每个槽有自己的锁、大块与空闲链表，
+// 线程按首次使用的顺序轮流绑定到槽上，多线程下各分片的结点分配基本不会争用同一把锁。
+// 缓存的结点与索引结点集中在少量大页上，随机访问时所需的TLB项远少于散落在各处的4KB页。
+// 内存只在池销毁时归还系统，池必须比使用它的缓存活得久
+class KHugePageArena
+{
+public:
+    static constexpr size_t kHugePageSize = 2u << 20;
+
+    // slotNum为0时取硬件线程数
+    explicit KHugePageArena(HugePageMode mode = HugePageMode::Transparent, size_t chunkSize = 32 * kHugePageSize,
+                            size_t slotNum = 0)
+        : mode_(mode)
+        , chunkSize_(roundUp(std::max(chunkSize, kHugePageSize), kHugePageSize))
+    {
+        if (slotNum == 0)
+            slotNum = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < slotNum; ++i)
+            slots_.emplace_back(new Slot());
+    }
+
+    ~KHugePageArena()
+    {
+        for (const Region& region : chunks_)
+            munmap(region.base, region.size);
+        for (const auto& large : largeRegions_)
+            munmap(large.second.base, large.second.size);
+    }
+
+    KHugePageArena(const KHugePageArena&) = delete;
+    KHugePageArena& operator=(const KHugePageArena&) = delete;
+
+    // 进程级默认池(透明大页)，供默认构造的HugePageAllocator使用
+    static KHugePageArena& defaultArena()
+    {
+        static KHugePageArena arena;
+        return arena;
+    }
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        if (alignment > kAlignment)
+            throw std::bad_alloc(); // 结点与桶数组都不需要超过16字节的对齐
+
+        size_t size = classSize(bytes);
+        if (size > kMediumSize)
+        {
+            std::lock_guard<std::mutex> lock(regionMutex_);
+            Region region = mapRegion(size);
+            largeRegions_.emplace(region.base, region);
+            largeLiveBytes_ += size;
+            return region.base;
+        }
+
+        Slot& slot = currentSlot();
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.liveBytes += size;
+        FreeBlock*& freeList = slot.freeLists[classIndex(size)];
+        if (freeList)
+        {
+            FreeBlock* block = freeList;
+            freeList = block->next;
+            return block;
+        }
+        if (static_cast<size_t>(slot.end - slot.cursor) < size)
+        {
+            // 大块剩余部分不够时直接换新块，尾部最多浪费一个中等块的大小
+            std::lock_guard<std::mutex> regionLock(regionMutex_);
+            chunks_.push_back(mapRegion(chunkSize_));
+            slot.cursor = static_cast<char*>(chunks_.back().base);
+            slot.end = slot.cursor + chunkSize_;
+        }
+        void* result = slot.cursor;
+        slot.cursor += size;
+        return result;
+    }
+
+    // 块挂到释放线程所在槽的空闲链表上，由该槽之后的分配复用
+    void deallocate(void* ptr, size_t bytes) noexcept
+    {
+        if (!ptr)
+            return;
+        size_t size = classSize(bytes);
+        if (size > kMediumSize)
+        {
+            std::lock_guard<std::mutex> lock(regionMutex_);
+            auto it = largeRegions_.find(ptr);
+            if (it == largeRegions_.end())
+                return;
+            unmapRegion(it->second);
+            largeLiveBytes_ -= size;
+            largeRegions_.erase(it);
+            return;
+        }
+
+        Slot& slot = currentSlot();
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.liveBytes -= size;
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        FreeBlock*& freeList = slot.freeLists[classIndex(size)];
+        block->next = freeList;
+        freeList = block;
+    }
+
+    ArenaStats stats()
+    {
+        ArenaStats result;
+        {
+            std::lock_guard<std::mutex> lock(regionMutex_);
+            result.mappedBytes = mappedBytes_;
+            result.hugeTlbBytes = hugeTlbBytes_;
+            result.liveBytes = largeLiveBytes_;
+        }
+        // 释放线程与分配线程可能落在不同槽上，单个槽的计数允许为"负"，求和后才有意义
+        for (const auto& slot : slots_)
+        {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            result.liveBytes += slot->liveBytes;
+        }
+        return result;
+    }
+
+    HugePageMode mode() const { return mode_; }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct Region
+    {
+        void*  base;
+        size_t size;
+        bool   hugeTlb;
+    };
+
+    static constexpr size_t kAlignment = 16;
+    static constexpr size_t kSmallSize = 4096;               // 不超过该大小的按16字节分类
+    static constexpr size_t kMediumSize = kHugePageSize / 2; // 不超过该大小的按2的幂分类，超过则单独映射
+    static constexpr size_t kSmallClasses = kSmallSize / kAlignment + 1;
+
+    // 独占缓存行，避免不同槽的锁与计数互相伪共享
+    struct alignas(64) Slot
+    {
+        std::mutex              mutex;
+        char*                   cursor = nullptr; // 当前大块中尚未切分部分的起点
+        char*                   end = nullptr;
+        size_t                  liveBytes = 0;
+        std::vector<FreeBlock*> freeLists = std::vector<FreeBlock*>(classIndex(kMediumSize) + 1, nullptr);
+    };
+
+    static size_t roundUp(size_t n, size_t alignment)
+    {
+        return (n + alignment - 1) / alignment * alignment;
+    }
+
+    // 请求大小对应的实际分配大小：小对象按16字节取整，中等对象取整到2的幂，大块取整到2MB
+    static size_t classSize(size_t bytes)
+    {
+        size_t size = roundUp(std::max<size_t>(bytes, 1), kAlignment);
+        if (size <= kSmallSize)
+            return size;
+        if (size > kMediumSize)
+            return roundUp(size, kHugePageSize);
+        size_t pow2 = kSmallSize * 2;
+        while (pow2 < size)
+            pow2 *= 2;
+        return pow2;
+    }
+
+    // 空闲链表下标：小对象为 大小/16，中等对象依次排在其后
+    static size_t classIndex(size_t size)
+    {
+        if (size <= kSmallSize)
+            return size / kAlignment;
+        size_t index = kSmallClasses;
+        for (size_t pow2 = kSmallSize * 2; pow2 < size; pow2 *= 2)
+            ++index;
+        return index;
+    }
+
+    // 每个线程第一次使用时按轮转领取一个序号，之后固定落在 序号 % 槽数 的槽上
+    Slot& currentSlot()
+    {
+        static std::atomic<size_t> nextThread{0};
+        thread_local size_t threadIndex = nextThread.fetch_add(1, std::memory_order_relaxed);
+        return *slots_[threadIndex % slots_.size()];
+    }
+
+    // size为2MB的整数倍；返回2MB对齐的区域。调用方需持有regionMutex_
+    Region mapRegion(size_t size)
+    {
+#ifdef MAP_HUGETLB
+        if (mode_ == HugePageMode::HugeTlb)
+        {
+            void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base != MAP_FAILED)
+                return countRegion(base, size, true);
+            // 没有预留hugetlb页(vm.nr_hugepages为0)时退回透明大页
+        }
+#endif
+        // 多映射2MB再裁掉首尾，得到2MB对齐的区域，透明大页才能覆盖整个区域
+        size_t mapped = size + kHugePageSize;
+        void* raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc();
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = roundUp(start, kHugePageSize);
+        if (aligned > start)
+            munmap(raw, aligned - start);
+        if (start + mapped > aligned + size)
+            munmap(reinterpret_cast<void*>(aligned + size), start + mapped - aligned - size);
+
+        void* base = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+        madvise(base, size, mode_ == HugePageMode::Disabled ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+#endif
+        return countRegion(base, size, false);
+    }
+
+    Region countRegion(void* base, size_t size, bool hugeTlb)
+    {
+        mappedBytes_ += size;
+        if (hugeTlb)
+            hugeTlbBytes_ += size;
+        return Region{base, size, hugeTlb};
+    }
+
+    // 调用方需持有regionMutex_
+    void unmapRegion(const Region& region)
+    {
+        munmap(region.base, region.size);
+        mappedBytes_ -= region.size;
+        if (region.hugeTlb)
+            hugeTlbBytes_ -= region.size;
+    }
+
+private:
+    HugePageMode                       mode_;
+    size_t                             chunkSize_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+
+    // 以下成员由regionMutex_保护；只有换新块与超过1MB的分配才会取该锁
+    std::mutex                         regionMutex_;
+    std::vector<Region>                chunks_;       // 各槽切分用的大块，池销毁时才归还
+    std::unordered_map<void*, Region>  largeRegions_; // 单独映射的大块分配，按起始地址查找
+    size_t                             mappedBytes_ = 0;
+    size_t                             hugeTlbBytes_ = 0;
+    size_t                             largeLiveBytes_ = 0;
+};
+
+// 从KHugePageArena分配的STL分配器；默认构造时使用进程级默认池。
+// 作为KLruCache/KHashLruCaches的Alloc模板参数，结点、shared_ptr控制块与索引都从池中分配
+template<typename T>
+class HugePageAllocator
+{
+public:
+    using value_type = T;
+
+    HugePageAllocator() noexcept
+        : arena_(&KHugePageArena::defaultArena())
+    {}
+
+    explicit HugePageAllocator(KHugePageArena& arena) noexcept
+        : arena_(&arena)
+    {}
+
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+        : arena_(other.arena())
+    {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        arena_->deallocate(ptr, n * sizeof(T));
+    }
+
+    KHugePageArena* arena() const noexcept { return arena_; }
+
+private:
+    KHugePageArena* arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept
+{
+    return lhs.arena() == rhs.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+} // namespace KamaCache
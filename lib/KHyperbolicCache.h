@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "KICachePolicy.h"
+#include "KKeyRef.h"
+
+namespace KamaCache
+{
+
+// Hyperbolic缓存(Blankstein等)：条目的优先级为 cost * 命中次数 / 在缓存中的时间，
+// 热度随时间自然衰减，不需要LFU-Aging那样周期性地整体减半。
+// 优先级随时间不断变化，因此不维护任何有序结构：命中只对条目自己的计数器原子加一，
+// 淘汰时随机抽样若干条目，淘汰其中优先级最低的一个。
+// 时间使用逻辑时钟，每插入一个新条目加一
+template<typename Key, typename Value>
+class KHyperbolicCache : public KICachePolicy<Key, Value>
+{
+private:
+    struct Slot
+    {
+        Key                   key;
+        Value                 value;
+        std::atomic<uint32_t> hits{0};
+        uint64_t              insertedAt = 0; // 进入缓存时的逻辑时间
+        double                cost = 1.0;     // 重新获取该条目的代价，越大越不应被淘汰
+    };
+
+public:
+    // samples: 每次淘汰抽样的条目数
+    explicit KHyperbolicCache(size_t capacity, int samples = 64)
+        : capacity_(capacity)
+        , samples_(std::max(1, samples))
+        , now_(0)
+        , size_(0)
+        , slots_(capacity)
+        , gen_(std::random_device{}())
+    {
+        index_.reserve(capacity);
+    }
+
+    ~KHyperbolicCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, 1.0);
+    }
+
+    // 带代价的插入：已存在的key更新value与代价并计一次命中
+    void put(Key key, Value value, double cost)
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(KeyRef<Key>(key));
+        if (it != index_.end())
+        {
+            Slot& slot = slots_[it->second];
+            slot.value = value;
+            slot.cost = cost;
+            slot.hits.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ++now_;
+        size_t pos = size_ < capacity_ ? size_++ : evict();
+        Slot& slot = slots_[pos];
+        slot.key = key;
+        slot.value = value;
+        slot.hits.store(1, std::memory_order_relaxed);
+        slot.insertedAt = now_;
+        slot.cost = cost;
+        index_.emplace(KeyRef<Key>(slot.key), pos);
+    }
+
+    // 命中只需共享加锁，并对条目自己的计数器加一
+    bool get(Key key, Value& value) override
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(KeyRef<Key>(key));
+        if (it == index_.end())
+            return false;
+
+        Slot& slot = slots_[it->second];
+        slot.hits.fetch_add(1, std::memory_order_relaxed);
+        value = slot.value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只读查询：不计入命中次数
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(KeyRef<Key>(key));
+        if (it == index_.end())
+            return false;
+        value = slots_[it->second].value;
+        return true;
+    }
+
+    bool contains(Key key)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return index_.find(KeyRef<Key>(key)) != index_.end();
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+private:
+    double priority(const Slot& slot) const
+    {
+        // 刚插入的条目age为1，避免除零
+        uint64_t age = now_ - slot.insertedAt + 1;
+        return slot.cost * slot.hits.load(std::memory_order_relaxed) / static_cast<double>(age);
+    }
+
+    // 抽样选出优先级最低的条目，返回其槽位供新条目复用
+    size_t evict()
+    {
+        std::uniform_int_distribution<size_t> dist(0, size_ - 1);
+        size_t victim = dist(gen_);
+        double lowest = priority(slots_[victim]);
+        for (int i = 1; i < samples_; ++i)
+        {
+            size_t pos = dist(gen_);
+            double p = priority(slots_[pos]);
+            if (p < lowest)
+            {
+                lowest = p;
+                victim = pos;
+            }
+        }
+
+        auto it = index_.find(KeyRef<Key>(slots_[victim].key));
+        index_.erase(it);
+        return victim;
+    }
+
+private:
+    size_t                                  capacity_;
+    int                                     samples_;
+    uint64_t                                now_;    // 逻辑时钟，每插入一个新条目加一
+    size_t                                  size_;   // slots_中前size_个槽位已被使用
+    std::vector<Slot>                       slots_;  // 预先分配的扁平槽位数组
+    std::unordered_map<KeyRef<Key>, size_t> index_;  // key -> 槽位下标
+    std::mt19937                            gen_;    // 抽样用，只在独占锁内使用
+    std::shared_mutex                       mutex_;  // 命中共享加锁，插入与淘汰独占加锁
+};
+
+} // namespace KamaCache
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+namespace KamaCache
+{
+
+// 索引(nodeMap_/ghostCache_等)中使用的键引用。
+// 小而可平凡拷贝的键(如int)直接内联存储；其余键(如std::string)只保存指向
+// 结点内部key的指针，键的字节只在结点中存一份，索引与结点共享同一份键。
+template<typename Key,
+         bool Inline = std::is_trivially_copyable<Key>::value && sizeof(Key) <= sizeof(const Key*)>
+class KeyRef;
+
+template<typename Key>
+class KeyRef<Key, true>
+{
+public:
+    explicit KeyRef(const Key& key) : key_(key) {}
+
+    const Key& get() const { return key_; }
+
+    bool operator==(const KeyRef& other) const { return key_ == other.key_; }
+
+private:
+    Key key_;
+};
+
+template<typename Key>
+class KeyRef<Key, false>
+{
+public:
+    // 插入索引时必须引用结点中的key，保证被引用的键比索引项活得更久；
+    // 仅用于查找时可以引用临时的key
+    explicit KeyRef(const Key& key) : key_(&key) {}
+
+    const Key& get() const { return *key_; }
+
+    bool operator==(const KeyRef& other) const { return *key_ == *other.key_; }
+
+private:
+    const Key* key_;
+};
+
+} // namespace KamaCache
+
+namespace std
+{
+
+template<typename Key, bool Inline>
+struct hash<KamaCache::KeyRef<Key, Inline>>
+{
+    size_t operator()(const KamaCache::KeyRef<Key, Inline>& ref) const
+    {
+        return hash<Key>()(ref.get());
+    }
+};
+
+} // namespace std
@@ -1,18 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "KBulkLoad.h"
+#include "KCacheDump.h"
 #include "KICachePolicy.h"
+#include "KKeyRef.h"
+#include "KLockPolicy.h"
 
 namespace KamaCache
 {
 
-template<typename Key, typename Value> class KLfuCache;
+// Lock为锁策略(见KLockPolicy.h)
+template<typename Key, typename Value, typename Lock = std::shared_mutex> class KLfuCache;
 
 template<typename Key, typename Value>
 class FreqList
@@ -79,16 +92,16 @@ public:
 
     NodePtr getFirstNode() const { return head_->next; }
     
-    friend class KLfuCache<Key, Value>;
+    template<typename, typename, typename> friend class KLfuCache;
 };
 
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Lock>
 class KLfuCache : public KICachePolicy<Key, Value>
 {
 public:
     using Node = typename FreqList<Key, Value>::Node;
     using NodePtr = std::shared_ptr<Node>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = std::unordered_map<KeyRef<Key>, NodePtr>; // 索引中的键引用结点内的key
 
     KLfuCache(int capacity, int maxAverageNum = 1000000)
     : capacity_(capacity), minFreq_(INT8_MAX), maxAverageNum_(maxAverageNum),
@@ -102,8 +115,8 @@ public:
         if (capacity_ == 0)
             return;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
         if (it != nodeMap_.end())
         {
             // 重置其value值
@@ -119,8 +132,8 @@ public:
     // value值为传出参数
     bool get(Key key, Value& value) override
     {
-      std::lock_guard<std::mutex> lock(mutex_);
-      auto it = nodeMap_.find(key);
+      std::lock_guard<Lock> lock(mutex_);
+      auto it = nodeMap_.find(KeyRef<Key>(key));
       if (it != nodeMap_.end())
       {
           getInternal(it->second, value);
@@ -137,6 +150,100 @@ public:
       return value;
     }
 
+    // 只读查询：不增加访问频次，共享加锁，与其他只读查询互不阻塞
+    bool peek(Key key, Value& value)
+    {
+      std::shared_lock<Lock> lock(mutex_);
+      auto it = nodeMap_.find(KeyRef<Key>(key));
+      if (it == nodeMap_.end())
+          return false;
+      value = it->second->value;
+      return true;
+    }
+
+    bool contains(Key key)
+    {
+      std::shared_lock<Lock> lock(mutex_);
+      return nodeMap_.find(KeyRef<Key>(key)) != nodeMap_.end();
+    }
+
+    // 同peek，未命中时返回空
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+      Value value{};
+      if (peek(key, value))
+          return value;
+      return std::nullopt;
+    }
+
+    // 原地更新：在同一次加锁内对缓存中的value调用fn(Value&)，不拷贝value，命中计为一次访问。
+    // 返回key是否存在
+    template<typename Fn>
+    bool computeIfPresent(Key key, Fn fn)
+    {
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it == nodeMap_.end())
+            return false;
+        fn(it->second->value);
+        touchInternal(it->second);
+        return true;
+    }
+
+    // 存在时原地调用fn(Value&)；不存在时对Value{}调用fn后插入。返回调用前key是否存在
+    template<typename Fn>
+    bool compute(Key key, Fn fn)
+    {
+        if (capacity_ <= 0)
+            return false;
+
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end())
+        {
+            fn(it->second->value);
+            touchInternal(it->second);
+            return true;
+        }
+
+        // fn先作用于局部值，抛出异常时缓存保持不变
+        Value value{};
+        fn(value);
+        putInternal(key, std::move(value));
+        return false;
+    }
+
+    // 不存在时插入delta；存在时原地调用fn(Value& current, const Value& delta)合并
+    template<typename Fn>
+    void merge(Key key, const Value& delta, Fn fn)
+    {
+        if (capacity_ <= 0)
+            return;
+
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end())
+        {
+            fn(it->second->value, delta);
+            touchInternal(it->second);
+            return;
+        }
+        putInternal(key, delta);
+    }
+
+    // 运行时调整容量(至少为1)，缩小时立即淘汰访问频次最低的数据直到不超过新容量
+    void setCapacity(int capacity)
+    {
+        std::lock_guard<Lock> lock(mutex_);
+        capacity_ = std::max(capacity, 1);
+        while (nodeMap_.size() > static_cast<size_t>(capacity_))
+        {
+            int evictFreq = minFreq_;
+            kickOut();
+            updateMinFreqIfEmpty(evictFreq);
+        }
+    }
+
       // 清空缓存,回收资源
     void purge()
     {
@@ -144,9 +251,64 @@ public:
       freqToFreqList_.clear();
     }
 
+    // 批量预热：只加一次锁导入[first, last)，元素为(key, value)或(key, value, freq)。
+    // 给出freq时按该访问次数建立频次链表，否则视为访问一次；
+    // 超出容量时保留频次最高的数据，频次相同时先导入的先被淘汰
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        using Item = typename std::iterator_traits<InputIt>::value_type;
+        if (capacity_ <= 0)
+            return;
+
+        std::lock_guard<Lock> lock(mutex_);
+        nodeMap_.reserve(capacity_);
+        for (; first != last; ++first)
+        {
+            int freq = 1;
+            if constexpr (std::tuple_size<Item>::value > 2)
+                freq = std::max(1, static_cast<int>(std::get<2>(*first)));
+            bulkPutInternal(std::get<0>(*first), std::get<1>(*first), freq);
+        }
+    }
+
+    // 拷贝出当前内容(key, value, freq)：按频次桶从高到低排列，同一频次内最近加入的在前
+    std::vector<std::tuple<Key, Value, int>> snapshot()
+    {
+        std::shared_lock<Lock> lock(mutex_);
+        std::vector<int> freqs;
+        for (const auto& pair : freqToFreqList_)
+        {
+            if (pair.second && !pair.second->isEmpty())
+                freqs.push_back(pair.first);
+        }
+        std::sort(freqs.begin(), freqs.end(), std::greater<int>());
+
+        std::vector<std::tuple<Key, Value, int>> entries;
+        entries.reserve(nodeMap_.size());
+        for (int freq : freqs)
+        {
+            FreqList<Key, Value>* list = freqToFreqList_.at(freq);
+            for (NodePtr node = list->tail_->pre.lock(); node && node != list->head_; node = node->pre.lock())
+            {
+                entries.emplace_back(node->key, node->value, node->freq);
+            }
+        }
+        return entries;
+    }
+
+    // 按频次从高到低分块导出，每块不超过chunkSize个，回调在锁外执行
+    template<typename Fn>
+    void dump(Fn fn, size_t chunkSize = 256)
+    {
+        streamInChunks(snapshot(), chunkSize, fn);
+    }
+
 private:
     void putInternal(Key key, Value value); // 添加缓存
     void getInternal(NodePtr node, Value& value); // 获取缓存
+    void touchInternal(NodePtr node); // 访问频次加一，不拷贝value
+    void bulkPutInternal(const Key& key, const Value& value, int freq); // 以给定访问次数添加缓存
 
     void kickOut(); // 移除缓存中的过期数据
 
@@ -157,24 +319,31 @@ private:
     void decreaseFreqNum(int num); // 减少平均访问等频率
     void handleOverMaxAverageNum(); // 处理当前平均访问频率超过上限的情况
     void updateMinFreq();
+    void updateMinFreqIfEmpty(int freq); // freq为最小频次且其链表已空时重新计算最小频次
 
 private:
-    int                                            capacity_; // 缓存容量
+    std::atomic<int>                               capacity_; // 缓存容量，可由setCapacity在运行时调整
     int                                            minFreq_; // 最小访问频次(用于找到最小访问频次结点)
     int                                            maxAverageNum_; // 最大平均访问频次
     int                                            curAverageNum_; // 当前平均访问频次
     int                                            curTotalNum_; // 当前访问所有缓存次数总数 
-    std::mutex                                     mutex_; // 互斥锁
+    Lock                                           mutex_; // 锁策略，默认读写锁，只读查询共享加锁
     NodeMap                                        nodeMap_; // key 到 缓存节点的映射
     std::unordered_map<int, FreqList<Key, Value>*> freqToFreqList_;// 访问频次到该频次链表的映射
 };
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::getInternal(NodePtr node, Value& value)
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::getInternal(NodePtr node, Value& value)
 {
     // 找到之后需要将其从低访问频次的链表中删除，并且添加到+1的访问频次链表中，
     // 访问频次+1, 然后把value值返回
     value = node->value;
+    touchInternal(node);
+}
+
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::touchInternal(NodePtr node)
+{
     // 从原有访问频次的链表中删除节点
     removeFromFreqList(node); 
     node->freq++;
@@ -188,11 +357,11 @@ void KLfuCache<Key, Value>::getInternal(NodePtr node, Value& value)
     addFreqNum();
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::putInternal(Key key, Value value)
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::putInternal(Key key, Value value)
 {   
     // 如果不在缓存中，则需要判断缓存是否已满
-    if (nodeMap_.size() == capacity_)
+    if (nodeMap_.size() == static_cast<size_t>(capacity_))
     {
         // 缓存已满，删除最不常访问的结点，更新当前平均访问频次和总访问频次
         kickOut();
@@ -200,23 +369,61 @@ void KLfuCache<Key, Value>::putInternal(Key key, Value value)
     
     // 创建新结点，将新结点添加进入，更新最小访问频次
     NodePtr node = std::make_shared<Node>(key, value);
-    nodeMap_[key] = node;
+    nodeMap_.emplace(KeyRef<Key>(node->key), node);
     addToFreqList(node);
     addFreqNum();
     minFreq_ = std::min(minFreq_, 1);
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::kickOut()
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::bulkPutInternal(const Key& key, const Value& value, int freq)
+{
+    auto it = nodeMap_.find(KeyRef<Key>(key));
+    if (it != nodeMap_.end())
+    {
+        // 已存在则更新value并累加访问次数
+        NodePtr node = it->second;
+        node->value = value;
+        removeFromFreqList(node);
+        int oldFreq = node->freq;
+        node->freq += freq;
+        addToFreqList(node);
+        updateMinFreqIfEmpty(oldFreq);
+    }
+    else
+    {
+        if (nodeMap_.size() == static_cast<size_t>(capacity_))
+        {
+            // 新数据的频次比缓存中所有数据都低，它本身就是该被淘汰的那一个
+            if (freq < minFreq_)
+                return;
+            int evictFreq = minFreq_;
+            kickOut();
+            updateMinFreqIfEmpty(evictFreq);
+        }
+
+        NodePtr node = std::make_shared<Node>(key, value);
+        node->freq = freq;
+        nodeMap_.emplace(KeyRef<Key>(node->key), node);
+        addToFreqList(node);
+        minFreq_ = nodeMap_.size() == 1 ? freq : std::min(minFreq_, freq);
+    }
+
+    curTotalNum_ += freq - 1;
+    addFreqNum();
+}
+
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::kickOut()
 {
     NodePtr node = freqToFreqList_[minFreq_]->getFirstNode();
     removeFromFreqList(node);
-    nodeMap_.erase(node->key);
+    nodeMap_.erase(KeyRef<Key>(node->key));
     decreaseFreqNum(node->freq);
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::removeFromFreqList(NodePtr node)
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::removeFromFreqList(NodePtr node)
 {
     // 检查结点是否为空
     if (!node) 
@@ -226,8 +433,8 @@ void KLfuCache<Key, Value>::removeFromFreqList(NodePtr node)
     freqToFreqList_[freq]->removeNode(node);
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::addToFreqList(NodePtr node)
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::addToFreqList(NodePtr node)
 {
     // 检查结点是否为空
     if (!node) 
@@ -244,8 +451,8 @@ void KLfuCache<Key, Value>::addToFreqList(NodePtr node)
     freqToFreqList_[freq]->addNode(node);
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::addFreqNum()
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::addFreqNum()
 {
     curTotalNum_++;
     if (nodeMap_.empty())
@@ -259,8 +466,8 @@ void KLfuCache<Key, Value>::addFreqNum()
     }
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::decreaseFreqNum(int num)
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::decreaseFreqNum(int num)
 {
     // 减少平均访问频次和总访问频次
     curTotalNum_ -= num;
@@ -270,8 +477,8 @@ void KLfuCache<Key, Value>::decreaseFreqNum(int num)
         curAverageNum_ = curTotalNum_ / nodeMap_.size();
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::handleOverMaxAverageNum()
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::handleOverMaxAverageNum()
 {
     if (nodeMap_.empty())
         return;
@@ -300,10 +507,11 @@ void KLfuCache<Key, Value>::handleOverMaxAverageNum()
     updateMinFreq();
 }
 
-template<typename Key, typename Value>
-void KLfuCache<Key, Value>::updateMinFreq() 
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::updateMinFreq() 
 {
-    minFreq_ = INT8_MAX;
+    // 批量导入的频次可能超过INT8_MAX，这里用int的最大值作为哨兵
+    minFreq_ = std::numeric_limits<int>::max();
     for (const auto& pair : freqToFreqList_) 
     {
         if (pair.second && !pair.second->isEmpty()) 
@@ -311,23 +519,33 @@ void KLfuCache<Key, Value>::updateMinFreq()
             minFreq_ = std::min(minFreq_, pair.first);
         }
     }
-    if (minFreq_ == INT8_MAX) 
+    if (minFreq_ == std::numeric_limits<int>::max()) 
         minFreq_ = 1;
 }
 
+template<typename Key, typename Value, typename Lock>
+void KLfuCache<Key, Value, Lock>::updateMinFreqIfEmpty(int freq)
+{
+    if (freq != minFreq_)
+        return;
+    auto it = freqToFreqList_.find(freq);
+    if (it == freqToFreqList_.end() || !it->second || it->second->isEmpty())
+        updateMinFreq();
+}
+
 // 并没有牺牲空间换时间，他是把原有缓存大小进行了分片。
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Lock = std::shared_mutex>
 class KHashLfuCache
 {
 public:
     KHashLfuCache(size_t capacity, int sliceNum, int maxAverageNum = 10)
-        : sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
-        , capacity_(capacity)
+        : capacity_(capacity)
+        , sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
     {
         size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_)); // 每个lfu分片的容量
         for (int i = 0; i < sliceNum_; ++i)
         {
-            lfuSliceCaches_.emplace_back(new KLfuCache<Key, Value>(sliceSize, maxAverageNum));
+            lfuSliceCaches_.emplace_back(new KLfuCache<Key, Value, Lock>(sliceSize, maxAverageNum));
         }
     }
 
@@ -345,6 +563,41 @@ public:
         return lfuSliceCaches_[sliceIndex]->get(key, value);
     }
 
+    // 只读查询，不增加分片内的访问频次
+    bool peek(Key key, Value& value)
+    {
+        return lfuSliceCaches_[Hash(key) % sliceNum_]->peek(key, value);
+    }
+
+    bool contains(Key key)
+    {
+        return lfuSliceCaches_[Hash(key) % sliceNum_]->contains(key);
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        return lfuSliceCaches_[Hash(key) % sliceNum_]->getIfPresentQuiet(key);
+    }
+
+    // 原地更新，均在key所在分片的一次加锁内完成
+    template<typename Fn>
+    bool computeIfPresent(Key key, Fn fn)
+    {
+        return lfuSliceCaches_[Hash(key) % sliceNum_]->computeIfPresent(key, fn);
+    }
+
+    template<typename Fn>
+    bool compute(Key key, Fn fn)
+    {
+        return lfuSliceCaches_[Hash(key) % sliceNum_]->compute(key, fn);
+    }
+
+    template<typename Fn>
+    void merge(Key key, const Value& delta, Fn fn)
+    {
+        lfuSliceCaches_[Hash(key) % sliceNum_]->merge(key, delta, fn);
+    }
+
     Value get(Key key)
     {
         Value value;
@@ -352,6 +605,32 @@ public:
         return value;
     }
 
+    // 批量预热：按分片划分输入后并行构建各分片，元素可带访问次数(key, value, freq)
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        bulkLoadSlices(lfuSliceCaches_, first, last, [this](const Key& key) { return Hash(key); });
+    }
+
+    // 逐个分片导出：每个分片在自己的锁内拷贝快照，再在锁外分块交给回调
+    template<typename Fn>
+    void dump(Fn fn, size_t chunkSize = 256)
+    {
+        for (auto& slice : lfuSliceCaches_)
+        {
+            streamInChunks(slice->snapshot(), chunkSize, fn);
+        }
+    }
+
+    // 运行时调整总容量，按分片平均分配
+    void setCapacity(size_t capacity)
+    {
+        capacity_ = capacity;
+        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum_));
+        for (auto& slice : lfuSliceCaches_)
+            slice->setCapacity(static_cast<int>(sliceSize));
+    }
+
     // 清除缓存
     void purge()
     {
@@ -370,9 +649,9 @@ private:
     }
 
 private:
-    size_t capacity_; // 缓存总容量
+    std::atomic<size_t> capacity_; // 缓存总容量
     int sliceNum_; // 缓存分片数量
-    std::vector<std::unique_ptr<KLfuCache<Key, Value>>> lfuSliceCaches_; // 缓存lfu分片容器
+    std::vector<std::unique_ptr<KLfuCache<Key, Value, Lock>>> lfuSliceCaches_; // 缓存lfu分片容器
 };
 
 } // namespace KamaCache
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace KamaCache
+{
+
+// 可作为缓存模板参数的锁策略。每种锁都同时提供独占(lock/unlock)与共享(lock_shared/unlock_shared)接口，
+// 以便直接配合std::lock_guard与std::shared_lock使用；不区分读写的锁把共享加锁当作独占加锁。
+// 可选：
+//   std::shared_mutex - 读写锁，只读查询之间互不阻塞(默认)
+//   KMutexLock        - std::mutex，竞争时由内核挂起线程
+//   KSpinLock         - TTAS自旋锁，指数退避，适合极短的临界区
+//   KAdaptiveLock     - 先自旋一段时间，仍拿不到锁再挂起
+//   KNullLock         - 空锁，只在单线程使用或外部已保证互斥时使用
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+class KNullLock
+{
+public:
+    void lock() {}
+    bool try_lock() { return true; }
+    void unlock() {}
+    void lock_shared() {}
+    bool try_lock_shared() { return true; }
+    void unlock_shared() {}
+};
+
+class KMutexLock
+{
+public:
+    void lock() { mutex_.lock(); }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+    void lock_shared() { lock(); }
+    bool try_lock_shared() { return try_lock(); }
+    void unlock_shared() { unlock(); }
+
+private:
+    std::mutex mutex_;
+};
+
+// test-and-test-and-set：先只读地等待锁空闲，再尝试交换，避免自旋时不断写同一缓存行；
+// 每次失败后退避时间翻倍，超过上限后让出CPU
+class KSpinLock
+{
+public:
+    void lock()
+    {
+        int backoff = 1;
+        while (true)
+        {
+            if (!locked_.exchange(true, std::memory_order_acquire))
+                return;
+            while (locked_.load(std::memory_order_relaxed))
+            {
+                if (backoff <= kMaxBackoff)
+                {
+                    for (int i = 0; i < backoff; ++i)
+                        cpuRelax();
+                    backoff <<= 1;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    bool try_lock()
+    {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() { locked_.store(false, std::memory_order_release); }
+    void lock_shared() { lock(); }
+    bool try_lock_shared() { return try_lock(); }
+    void unlock_shared() { unlock(); }
+
+private:
+    static constexpr int kMaxBackoff = 1024;
+
+    std::atomic<bool> locked_{false};
+};
+
+// 自旋若干次仍拿不到锁时调用std::mutex::lock挂起，兼顾短临界区的低延迟与长时间竞争时不空耗CPU
+class KAdaptiveLock
+{
+public:
+    void lock()
+    {
+        for (int i = 0; i < kSpinCount; ++i)
+        {
+            if (mutex_.try_lock())
+                return;
+            cpuRelax();
+        }
+        mutex_.lock();
+    }
+
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+    void lock_shared() { lock(); }
+    bool try_lock_shared() { return try_lock(); }
+    void unlock_shared() { unlock(); }
+
+private:
+    static constexpr int kSpinCount = 100;
+
+    std::mutex mutex_;
+};
+
+} // namespace KamaCache
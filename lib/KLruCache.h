@@ -1,18 +1,37 @@
 #pragma once 
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <future>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "KBulkLoad.h"
+#include "KCacheDump.h"
+#include "KFlatCombiner.h"
 #include "KICachePolicy.h"
+#include "KKeyRef.h"
+#include "KLockPolicy.h"
+#include "KMpscQueue.h"
 
 namespace KamaCache
 {
 
-// 前向声明
-template<typename Key, typename Value> class KLruCache;
+// 前向声明，Lock为锁策略(见KLockPolicy.h)；Alloc为结点与索引的分配器(如KHugePageArena.h中的HugePageAllocator)
+template<typename Key, typename Value, typename Lock = std::shared_mutex, typename Alloc = std::allocator<char>>
+class KLruCache;
 
 template<typename Key, typename Value>
 class LruNode 
@@ -32,31 +51,42 @@ public:
     {}
 
     // 提供必要的访问器
-    Key getKey() const { return key_; }
+    const Key& getKey() const { return key_; }
     Value getValue() const { return value_; }
     void setValue(const Value& value) { value_ = value; }
     size_t getAccessCount() const { return accessCount_; }
     void incrementAccessCount() { ++accessCount_; }
 
-    friend class KLruCache<Key, Value>;
+    template<typename, typename, typename, typename> friend class KLruCache;
 };
 
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Lock, typename Alloc>
 class KLruCache : public KICachePolicy<Key, Value>
 {
 public:
     using LruNodeType = LruNode<Key, Value>;
     using NodePtr = std::shared_ptr<LruNodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<LruNodeType>;
+    using MapAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<std::pair<const KeyRef<Key>, NodePtr>>;
+    using NodeMap = std::unordered_map<KeyRef<Key>, NodePtr, std::hash<KeyRef<Key>>, std::equal_to<KeyRef<Key>>,
+                                       MapAllocator>; // 索引中的键引用结点内的key
 
-    KLruCache(int capacity)
+    KLruCache(int capacity, const Alloc& alloc = Alloc())
         : capacity_(capacity)
+        , nodeMap_(MapAllocator(alloc))
+        , nodeAlloc_(alloc)
     {
         initializeList();
     }
 
-    ~KLruCache() override = default;
+    ~KLruCache() override
+    {
+        // 逐个断开next_，避免大容量时结点沿shared_ptr链递归析构导致栈溢出
+        NodePtr node = dummyHead_;
+        while (node)
+            node = std::move(node->next_);
+    }
 
     // 添加缓存
     void put(Key key, Value value) override
@@ -64,8 +94,8 @@ public:
         if (capacity_ <= 0)
             return;
     
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
         if (it != nodeMap_.end())
         {
             // 如果在当前容器中,则更新value,并调用get方法，代表该数据刚被访问
@@ -78,8 +108,8 @@ public:
 
     bool get(Key key, Value& value) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
         if (it != nodeMap_.end())
         {
             moveToMostRecent(it->second);
@@ -97,11 +127,92 @@ public:
         return value;
     }
 
+    // 只读查询：不调整LRU顺序，共享加锁，与其他只读查询互不阻塞
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it == nodeMap_.end())
+            return false;
+        value = it->second->getValue();
+        return true;
+    }
+
+    bool contains(Key key)
+    {
+        std::shared_lock<Lock> lock(mutex_);
+        return nodeMap_.find(KeyRef<Key>(key)) != nodeMap_.end();
+    }
+
+    // 同peek，未命中时返回空
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+    // 原地更新：在同一次加锁内对缓存中的value调用fn(Value&)，不拷贝value，命中视为一次访问。
+    // 返回key是否存在
+    template<typename Fn>
+    bool computeIfPresent(Key key, Fn fn)
+    {
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it == nodeMap_.end())
+            return false;
+        fn(it->second->value_);
+        moveToMostRecent(it->second);
+        return true;
+    }
+
+    // 存在时原地调用fn(Value&)；不存在时对Value{}调用fn后插入。返回调用前key是否存在
+    template<typename Fn>
+    bool compute(Key key, Fn fn)
+    {
+        if (capacity_ <= 0)
+            return false;
+
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end())
+        {
+            fn(it->second->value_);
+            moveToMostRecent(it->second);
+            return true;
+        }
+
+        // fn先作用于局部值，抛出异常时缓存保持不变
+        Value value{};
+        fn(value);
+        addNewNode(key, value);
+        return false;
+    }
+
+    // 不存在时插入delta；存在时原地调用fn(Value& current, const Value& delta)合并
+    template<typename Fn>
+    void merge(Key key, const Value& delta, Fn fn)
+    {
+        if (capacity_ <= 0)
+            return;
+
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end())
+        {
+            fn(it->second->value_, delta);
+            moveToMostRecent(it->second);
+            return;
+        }
+        addNewNode(key, delta);
+    }
+
     // 删除指定元素
     void remove(Key key) 
     {   
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
         if (it != nodeMap_.end())
         {
             removeNode(it->second);
@@ -109,12 +220,98 @@ public:
         }
     }
 
+    // 运行时调整容量(至少为1)，缩小时立即淘汰最久未访问的数据直到不超过新容量
+    void setCapacity(int capacity)
+    {
+        std::lock_guard<Lock> lock(mutex_);
+        capacity_ = std::max(capacity, 1);
+        while (nodeMap_.size() > static_cast<size_t>(capacity_))
+            evictLeastRecent();
+    }
+
+    // 批量预热：只加一次锁导入[first, last)中的(key, value)。
+    // 输入顺序即访问顺序，越靠后越新，超出容量时最先导入的数据先被淘汰
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        if (capacity_ <= 0)
+            return;
+
+        std::lock_guard<Lock> lock(mutex_);
+        nodeMap_.reserve(capacity_);
+        for (; first != last; ++first)
+        {
+            const Key& key = std::get<0>(*first);
+            const Value& value = std::get<1>(*first);
+            auto it = nodeMap_.find(KeyRef<Key>(key));
+            if (it != nodeMap_.end())
+                updateExistingNode(it->second, value);
+            else
+                addNewNode(key, value);
+        }
+    }
+
+    // 只在key不存在时写入，返回是否写入；已存在时不覆盖也不调整LRU顺序，把缓存中的值拷回value
+    bool putIfAbsent(Key key, Value& value)
+    {
+        if (capacity_ <= 0)
+            return false;
+
+        std::lock_guard<Lock> lock(mutex_);
+        auto it = nodeMap_.find(KeyRef<Key>(key));
+        if (it != nodeMap_.end())
+        {
+            value = it->second->getValue();
+            return false;
+        }
+        addNewNode(key, value);
+        return true;
+    }
+
+    // 同bulkLoad，但只导入缓存中还没有的key；已存在的key保留缓存中的值，并把它写回输入项
+    template<typename InputIt>
+    void bulkLoadIfAbsent(InputIt first, InputIt last)
+    {
+        if (capacity_ <= 0)
+            return;
+
+        std::lock_guard<Lock> lock(mutex_);
+        for (; first != last; ++first)
+        {
+            auto it = nodeMap_.find(KeyRef<Key>(std::get<0>(*first)));
+            if (it != nodeMap_.end())
+                std::get<1>(*first) = it->second->getValue();
+            else
+                addNewNode(std::get<0>(*first), std::get<1>(*first));
+        }
+    }
+
+    // 拷贝出当前内容，按MRU -> LRU排列，只在拷贝期间持有锁
+    std::vector<std::pair<Key, Value>> snapshot()
+    {
+        std::shared_lock<Lock> lock(mutex_);
+        std::vector<std::pair<Key, Value>> entries;
+        entries.reserve(nodeMap_.size());
+        for (NodePtr node = dummyTail_->prev_.lock(); node && node != dummyHead_; node = node->prev_.lock())
+        {
+            entries.emplace_back(node->getKey(), node->getValue());
+        }
+        return entries;
+    }
+
+    // 按MRU -> LRU顺序分块导出，每块不超过chunkSize个，回调在锁外执行
+    template<typename Fn>
+    void dump(Fn fn, size_t chunkSize = 256)
+    {
+        streamInChunks(snapshot(), chunkSize, fn);
+    }
+
 private:
     void initializeList()
     {
         // 创建首尾虚拟节点
-        dummyHead_ = std::make_shared<LruNodeType>(Key(), Value());
-        dummyTail_ = std::make_shared<LruNodeType>(Key(), Value());
+        dummyHead_ = std::allocate_shared<LruNodeType>(nodeAlloc_, Key(), Value());
+        dummyTail_ = std::allocate_shared<LruNodeType>(nodeAlloc_, Key(), Value());
         dummyHead_->next_ = dummyTail_;
         dummyTail_->prev_ = dummyHead_;
     }
@@ -127,14 +324,15 @@ private:
 
     void addNewNode(const Key& key, const Value& value) 
     {
-       if (nodeMap_.size() >= capacity_) 
+       if (nodeMap_.size() >= static_cast<size_t>(capacity_)) 
        {
            evictLeastRecent();
        }
 
-       NodePtr newNode = std::make_shared<LruNodeType>(key, value);
+       // 结点与shared_ptr控制块一起从nodeAlloc_分配
+       NodePtr newNode = std::allocate_shared<LruNodeType>(nodeAlloc_, key, value);
        insertNode(newNode);
-       nodeMap_[key] = newNode;
+       nodeMap_.emplace(KeyRef<Key>(newNode->getKey()), newNode);
     }
 
     // 将该节点移动到最新的位置
@@ -169,15 +367,16 @@ private:
     {
         NodePtr leastRecent = dummyHead_->next_;
         removeNode(leastRecent);
-        nodeMap_.erase(leastRecent->getKey());
+        nodeMap_.erase(KeyRef<Key>(leastRecent->getKey()));
     }
 
 private:
-    int           capacity_; // 缓存容量
-    NodeMap       nodeMap_; // key -> Node 
-    std::mutex    mutex_;
-    NodePtr       dummyHead_; // 虚拟头结点
-    NodePtr       dummyTail_;
+    std::atomic<int>  capacity_; // 缓存容量，可由setCapacity在运行时调整
+    NodeMap           nodeMap_; // key -> Node 
+    Lock              mutex_; // 只读查询(peek/contains/snapshot)共享加锁
+    NodePtr           dummyHead_; // 虚拟头结点
+    NodePtr           dummyTail_;
+    NodeAllocator     nodeAlloc_;
 };
 
 // LRU优化：Lru-k版本。 通过继承的方式进行再优化
@@ -271,34 +470,118 @@ private:
     std::unordered_map<Key, Value>          historyValueMap_; // 存储未达到k次访问的数据值
 };
 
+struct WriteBufferStats
+{
+    size_t batches = 0; // 排空并应用到分片的次数，每次加一次分片锁
+    size_t applied = 0; // 已应用的写入数
+};
+
 // lru优化：对lru进行分片，提高高并发使用的性能
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Lock = std::shared_mutex, typename Alloc = std::allocator<char>>
 class KHashLruCaches
 {
 public:
-    KHashLruCaches(size_t capacity, int sliceNum)
+    // flatCombining: 为每个分片启用平面合并，热点分片上的操作由抢到锁的线程批量执行，
+    //               合并者独占分片，分片本身不再加锁(此时Lock不起作用)；
+    //               每个分片只有少数线程竞争时它通常比直接加锁更慢，只适合大量线程集中访问少数热点分片的场景；
+    // writeBufferSize: 大于0时为每个分片启用该大小的写缓冲，put只入队，积累到一半时批量应用，
+    //                  读操作只在所查key可能还在缓冲中时才先应用缓冲(读己之写)；
+    // alloc: 所有分片共用的结点分配器
+    KHashLruCaches(size_t capacity, int sliceNum, bool flatCombining = false, size_t writeBufferSize = 0,
+                   const Alloc& alloc = Alloc())
         : capacity_(capacity)
         , sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
     {
         size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum_)); // 获取每个分片的大小
         for (int i = 0; i < sliceNum_; ++i)
         {
-            lruSliceCaches_.emplace_back(new KLruCache<Key, Value>(sliceSize)); 
+            if (flatCombining)
+            {
+                combinedSlices_.emplace_back(new CombinedSlice(sliceSize, alloc));
+                combiners_.emplace_back(new FlatCombiner());
+            }
+            else
+            {
+                lruSliceCaches_.emplace_back(new Slice(sliceSize, alloc));
+            }
+            if (writeBufferSize > 0)
+                writeBuffers_.emplace_back(new WriteBuffer(writeBufferSize));
         }
     }
 
     void put(Key key, Value value)
     {
         // 获取key的hash值，并计算出对应的分片索引
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        lruSliceCaches_[sliceIndex]->put(key, value);
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        if (!writeBuffers_.empty())
+        {
+            bufferedPut(sliceIndex, hash, std::move(key), std::move(value));
+            return;
+        }
+        withSlice(sliceIndex, [&](auto& slice) { slice.put(key, value); });
     }
 
     bool get(Key key, Value& value)
     {
         // 获取key的hash值，并计算出对应的分片索引
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        return lruSliceCaches_[sliceIndex]->get(key, value);
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.get(key, value); });
+    }
+
+    // 只读查询，不影响分片内的LRU顺序。启用写缓冲时，所查key可能还在本分片缓冲中的读操作先应用缓冲(读己之写)
+    bool peek(Key key, Value& value)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.peek(key, value); });
+    }
+
+    bool contains(Key key)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.contains(key); });
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.getIfPresentQuiet(key); });
+    }
+
+    // 原地更新，均在key所在分片的一次加锁内完成
+    template<typename Fn>
+    bool computeIfPresent(Key key, Fn fn)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.computeIfPresent(key, fn); });
+    }
+
+    template<typename Fn>
+    bool compute(Key key, Fn fn)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.compute(key, fn); });
+    }
+
+    template<typename Fn>
+    void merge(Key key, const Value& delta, Fn fn)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        withSlice(sliceIndex, [&](auto& slice) { slice.merge(key, delta, fn); });
     }
 
     Value get(Key key)
@@ -309,7 +592,392 @@ public:
         return value;
     }
 
+    // 批量预热：按分片划分输入后并行构建各分片，分片内保持输入顺序。
+    // 启用平面合并时分片不加锁，改为逐个分片交给合并者导入
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last)
+    {
+        flush();
+        if (combiners_.empty())
+        {
+            bulkLoadSlices(lruSliceCaches_, first, last, [this](const Key& key) { return Hash(key); });
+            return;
+        }
+        std::vector<std::vector<std::pair<Key, Value>>> groups(sliceNum_);
+        for (; first != last; ++first)
+            groups[Hash(std::get<0>(*first)) % sliceNum_].emplace_back(std::get<0>(*first), std::get<1>(*first));
+        loadGroups(groups);
+    }
+
+    // 逐个分片导出：每个分片在自己的锁内拷贝一份快照(MRU -> LRU)，再在锁外分块交给回调，
+    // 任何时刻最多只持有一个分片的锁
+    template<typename Fn>
+    void dump(Fn fn, size_t chunkSize = 256)
+    {
+        flush();
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            streamInChunks(withSlice(i, [](auto& slice) { return slice.snapshot(); }), chunkSize, fn);
+        }
+    }
+
+    // 读穿透：未命中时调用loader(key)加载并写入缓存。同一key同时只有一个加载在进行，
+    // 其他线程(包括getAllOrLoad中的批量加载)等待其结果；loader抛出的异常会传给所有等待者。
+    // 加载期间该key被put写入时，put的值更新，加载结果不再写入，调用方与等待者拿到的都是put的值
+    template<typename Loader>
+    Value getOrLoad(Key key, Loader loader)
+    {
+        Value value{};
+        if (get(key, value))
+            return value;
+
+        std::promise<std::optional<Value>> promise;
+        while (true)
+        {
+            std::shared_future<std::optional<Value>> waitFor;
+            {
+                std::lock_guard<std::mutex> lock(inflightMutex_);
+                auto it = inflight_.find(key);
+                if (it != inflight_.end())
+                    waitFor = it->second;
+                else if (loadedMeanwhile(key, value))
+                    return value;
+                else
+                    inflight_.emplace(key, promise.get_future().share());
+            }
+            if (!waitFor.valid())
+                break;
+
+            std::optional<Value> loaded = waitFor.get();
+            if (loaded)
+                return *loaded;
+            // 批量加载没有返回该key：重新登记为一次单独的加载，同样落空的其他等待者合并到这次加载上
+        }
+
+        try
+        {
+            value = loader(key);
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+            finishLoad(key);
+            throw;
+        }
+        storeLoaded(key, value);
+        promise.set_value(value);
+        finishLoad(key);
+        return value;
+    }
+
+    // 批量读穿透：先逐个查询，所有分片的未命中合并为一次bulkLoader(const std::vector<Key>&)调用，
+    // bulkLoader返回(key, value)序列(如std::unordered_map)，未返回的key视为不存在。
+    // 正在被其他线程加载的key不重复加载，等待其结果；加载结果按分片分组，每个分片只加一次锁写入，
+    // 同getOrLoad，加载期间已被put写入的key保留put的值。返回命中与加载到的全部(key, value)
+    template<typename BulkLoader>
+    std::unordered_map<Key, Value> getAllOrLoad(const std::vector<Key>& keys, BulkLoader bulkLoader)
+    {
+        std::unordered_map<Key, Value> result;
+        std::unordered_set<Key> seen;
+        std::vector<Key> misses;
+        for (const Key& key : keys)
+        {
+            if (!seen.insert(key).second)
+                continue;
+            Value value{};
+            if (get(key, value))
+                result.emplace(key, std::move(value));
+            else
+                misses.push_back(key);
+        }
+        if (misses.empty())
+            return result;
+
+        // 登记本次负责加载的key，已在加载中的key改为等待，期间已被其他线程加载完成的key直接取用
+        std::vector<Key> owned;
+        std::vector<std::promise<std::optional<Value>>> promises;
+        std::vector<std::pair<Key, std::shared_future<std::optional<Value>>>> waits;
+        {
+            std::lock_guard<std::mutex> lock(inflightMutex_);
+            owned.reserve(misses.size());
+            promises.reserve(misses.size());
+            for (const Key& key : misses)
+            {
+                auto it = inflight_.find(key);
+                if (it != inflight_.end())
+                {
+                    waits.emplace_back(key, it->second);
+                    continue;
+                }
+                Value value{};
+                if (loadedMeanwhile(key, value))
+                {
+                    result.emplace(key, std::move(value));
+                    continue;
+                }
+                promises.emplace_back();
+                inflight_.emplace(key, promises.back().get_future().share());
+                owned.push_back(key);
+            }
+        }
+
+        if (!owned.empty())
+        {
+            std::unordered_map<Key, Value> loaded;
+            try
+            {
+                for (auto& item : bulkLoader(owned))
+                    loaded[item.first] = item.second;
+            }
+            catch (...)
+            {
+                for (size_t i = 0; i < owned.size(); ++i)
+                {
+                    promises[i].set_exception(std::current_exception());
+                    finishLoad(owned[i]);
+                }
+                throw;
+            }
+
+            // 按分片分组，每个分片一次加锁写入；被put抢先的key换成缓存中的值
+            std::vector<std::vector<std::pair<Key, Value>>> groups(sliceNum_);
+            for (const auto& item : loaded)
+                groups[Hash(item.first) % sliceNum_].emplace_back(item.first, item.second);
+            loadGroups(groups, true);
+            for (const auto& group : groups)
+            {
+                for (const auto& item : group)
+                    loaded[item.first] = item.second;
+            }
+
+            for (size_t i = 0; i < owned.size(); ++i)
+            {
+                auto it = loaded.find(owned[i]);
+                if (it != loaded.end())
+                {
+                    promises[i].set_value(it->second);
+                    result.emplace(it->first, std::move(it->second));
+                }
+                else
+                {
+                    promises[i].set_value(std::nullopt);
+                }
+                finishLoad(owned[i]);
+            }
+        }
+
+        for (auto& wait : waits)
+        {
+            std::optional<Value> value = wait.second.get();
+            if (value)
+                result.emplace(wait.first, std::move(*value));
+        }
+        return result;
+    }
+
+    // 把所有分片写缓冲中的写入应用到分片
+    void flush()
+    {
+        for (size_t i = 0; i < writeBuffers_.size(); ++i)
+            flushSlice(i);
+    }
+
+    // 写缓冲的批量统计，各分片之和；applied / batches 即平均每次加锁应用的写入数
+    WriteBufferStats writeBufferStats() const
+    {
+        WriteBufferStats stats;
+        for (const auto& buffer : writeBuffers_)
+        {
+            stats.batches += buffer->batches.load(std::memory_order_relaxed);
+            stats.applied += buffer->applied.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    // 运行时调整总容量，按分片平均分配
+    void setCapacity(size_t capacity)
+    {
+        capacity_ = capacity;
+        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum_));
+        for (int i = 0; i < sliceNum_; ++i)
+            withSlice(i, [&](auto& slice) { slice.setCapacity(static_cast<int>(sliceSize)); });
+    }
+
 private:
+    using Slice = KLruCache<Key, Value, Lock, Alloc>;
+    using CombinedSlice = KLruCache<Key, Value, KNullLock, Alloc>; // 只由合并者访问，不需要加锁
+
+    struct WriteBuffer
+    {
+        KMpscQueue<std::pair<Key, Value>> queue;
+        std::mutex                        drainMutex; // 同一时刻只有一个线程消费queue
+        std::atomic<size_t>               pending{0}; // 已登记但尚未应用到分片的写入数
+        std::atomic<size_t>               applied{0}; // 已应用到分片的写入总数，与queue.enqueued()比较
+        std::atomic<size_t>               batches{0}; // 已应用的批数
+        // 按key哈希计数的尚未应用的写入数，为0时该槽内的key都不在缓冲中，读取无需排空(不同key可能共用一个槽)
+        std::unique_ptr<std::atomic<uint32_t>[]> pendingKeys;
+
+        explicit WriteBuffer(size_t size)
+            : queue(size)
+            , pendingKeys(new std::atomic<uint32_t>[kPendingKeySlots])
+        {
+            for (size_t i = 0; i < kPendingKeySlots; ++i)
+                pendingKeys[i].store(0, std::memory_order_relaxed);
+        }
+    };
+
+    static constexpr size_t kPendingKeySlots = 1024;
+
+    // 先登记再入队，pending积累到阈值时批量应用；缓冲满时由当前线程先排空
+    void bufferedPut(size_t sliceIndex, size_t hash, Key key, Value value)
+    {
+        WriteBuffer& buffer = *writeBuffers_[sliceIndex];
+        buffer.pendingKeys[pendingKeySlot(hash)].fetch_add(1, std::memory_order_acq_rel);
+        size_t pending = buffer.pending.fetch_add(1, std::memory_order_acq_rel) + 1;
+        std::pair<Key, Value> item(std::move(key), std::move(value));
+        while (!buffer.queue.tryPush(std::move(item)))
+        {
+            std::lock_guard<std::mutex> lock(buffer.drainMutex);
+            drainLocked(sliceIndex);
+        }
+
+        // 积累到一半时尝试批量应用，已有线程在排空时不等待
+        if (pending >= writeBufferThreshold(buffer))
+        {
+            std::unique_lock<std::mutex> lock(buffer.drainMutex, std::try_to_lock);
+            if (lock.owns_lock())
+                drainLocked(sliceIndex);
+        }
+    }
+
+    // 调用方持有inflightMutex_且key不在inflight_中：第一次查询未命中之后，其他加载者可能已经写入缓存并结束登记。
+    // 加载者总是先写入缓存再结束登记，所以这里看不到时说明确实需要加载
+    bool loadedMeanwhile(const Key& key, Value& value)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        return withSlice(sliceIndex, [&](auto& slice) { return slice.peek(key, value); });
+    }
+
+    // 写入单独加载的结果：直接写入分片而不经过写缓冲，之前入队的写入先应用，
+    // 此时key已存在说明加载期间被put写入过(登记前已确认不存在)，保留put的值并拷回value
+    void storeLoaded(const Key& key, Value& value)
+    {
+        size_t hash = Hash(key);
+        size_t sliceIndex = hash % sliceNum_;
+        flushKey(sliceIndex, hash);
+        withSlice(sliceIndex, [&](auto& slice) { slice.putIfAbsent(key, value); });
+    }
+
+    void finishLoad(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(inflightMutex_);
+        inflight_.erase(key);
+    }
+
+    // 读取key前的读己之写：key所在的计数槽为0时，调用方对该key的写入都已应用(计数在应用之后才减)，直接读分片；
+    // 否则排空本分片。读操作大多不需要排空，缓冲得以积累成批
+    void flushKey(size_t sliceIndex, size_t hash)
+    {
+        if (writeBuffers_.empty())
+            return;
+        if (writeBuffers_[sliceIndex]->pendingKeys[pendingKeySlot(hash)].load(std::memory_order_acquire) == 0)
+            return;
+        flushSlice(sliceIndex);
+    }
+
+    // 同一分片内的key哈希对sliceNum_同余，先除掉这部分再取模，让它们分散到各个槽
+    size_t pendingKeySlot(size_t hash) const
+    {
+        return hash / sliceNum_ % kPendingKeySlots;
+    }
+
+    // 返回前应用本分片在调用时刻之前领取入队位置的全部写入，调用方自己的写入一定在其中(读己之写)。
+    // 其他生产者已领取但尚未写完的单元会挡住tryPop，只能等它写完再继续排空；
+    // 调用之后的新写入不计入目标，持续写入也不会让读者一直追赶
+    void flushSlice(size_t sliceIndex)
+    {
+        if (writeBuffers_.empty())
+            return;
+        WriteBuffer& buffer = *writeBuffers_[sliceIndex];
+        size_t target = buffer.queue.enqueued();
+        if (buffer.applied.load(std::memory_order_acquire) >= target)
+            return;
+        std::lock_guard<std::mutex> lock(buffer.drainMutex);
+        while (true)
+        {
+            drainLocked(sliceIndex);
+            if (buffer.applied.load(std::memory_order_relaxed) >= target)
+                return;
+            std::this_thread::yield();
+        }
+    }
+
+    // 调用方持有drainMutex：取出缓冲中的全部写入，在分片的一次加锁内按入队顺序应用
+    void drainLocked(size_t sliceIndex)
+    {
+        WriteBuffer& buffer = *writeBuffers_[sliceIndex];
+        std::vector<std::pair<Key, Value>> batch;
+        std::pair<Key, Value> item;
+        while (buffer.queue.tryPop(item))
+            batch.push_back(std::move(item));
+        if (batch.empty())
+            return;
+        withSlice(sliceIndex, [&](auto& slice) { slice.bulkLoad(batch.begin(), batch.end()); });
+        for (const auto& entry : batch)
+            buffer.pendingKeys[pendingKeySlot(Hash(entry.first))].fetch_sub(1, std::memory_order_release);
+        buffer.pending.fetch_sub(batch.size(), std::memory_order_release);
+        buffer.applied.fetch_add(batch.size(), std::memory_order_release);
+        buffer.batches.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 在分片上执行fn(slice)并返回其结果：启用平面合并时由合并者在不加锁的分片上执行，
+    // 否则直接调用，由分片自己加锁。所有对分片的访问都经过这里
+    template<typename Fn>
+    auto withSlice(size_t sliceIndex, Fn fn) -> decltype(fn(std::declval<Slice&>()))
+    {
+        using Result = decltype(fn(std::declval<Slice&>()));
+        if (combiners_.empty())
+            return fn(*lruSliceCaches_[sliceIndex]);
+
+        CombinedSlice& slice = *combinedSlices_[sliceIndex];
+        if constexpr (std::is_void<Result>::value)
+        {
+            auto op = [&] { fn(slice); };
+            combiners_[sliceIndex]->execute(op);
+        }
+        else
+        {
+            std::optional<Result> result;
+            auto op = [&] { result.emplace(fn(slice)); };
+            combiners_[sliceIndex]->execute(op);
+            return std::move(*result);
+        }
+    }
+
+    // 按分片分组的写入，每个分片一次导入。ifAbsent为true时只写入不存在的key，已存在的把缓存中的值写回groups
+    void loadGroups(std::vector<std::vector<std::pair<Key, Value>>>& groups, bool ifAbsent = false)
+    {
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            if (groups[i].empty())
+                continue;
+            flushSlice(i);
+            withSlice(i, [&](auto& slice) {
+                if (ifAbsent)
+                    slice.bulkLoadIfAbsent(groups[i].begin(), groups[i].end());
+                else
+                    slice.bulkLoad(groups[i].begin(), groups[i].end());
+            });
+        }
+    }
+
+    static size_t writeBufferThreshold(const WriteBuffer& buffer)
+    {
+        return std::max<size_t>(1, buffer.queue.capacity() / 2);
+    }
+
     // 将key转换为对应hash值
     size_t Hash(Key key)
     {
@@ -318,9 +986,14 @@ private:
     }
 
 private:
-    size_t                                              capacity_;  // 总容量
-    int                                                 sliceNum_;  // 切片数量
-    std::vector<std::unique_ptr<KLruCache<Key, Value>>> lruSliceCaches_; // 切片LRU缓存
+    std::atomic<size_t>                                       capacity_;  // 总容量
+    int                                                       sliceNum_;  // 切片数量
+    std::vector<std::unique_ptr<Slice>>                       lruSliceCaches_; // 切片LRU缓存，启用平面合并时为空
+    std::vector<std::unique_ptr<CombinedSlice>>               combinedSlices_; // 启用平面合并时的切片，只由合并者访问
+    std::vector<std::unique_ptr<FlatCombiner>>                combiners_; // 每个分片的平面合并器，未启用时为空
+    std::vector<std::unique_ptr<WriteBuffer>>                 writeBuffers_; // 每个分片的写缓冲，未启用时为空
+    std::mutex                                                inflightMutex_;
+    std::unordered_map<Key, std::shared_future<std::optional<Value>>> inflight_; // 正在加载的key -> 加载结果
 };
 
 } // namespace KamaCache
\ No newline at end of file
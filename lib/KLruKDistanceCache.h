@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "KICachePolicy.h"
+#include "KKeyRef.h"
+
+namespace KamaCache
+{
+
+// 真正的LRU-K(O'Neil等)：每个条目记录最近K次访问的逻辑时间戳，
+// 淘汰"倒数第K次访问时间最早"(即向后K距离最大)的条目；访问不足K次的条目K距离视为无穷大，
+// 它们之间按最近一次访问时间做LRU。条目组织成带位置索引的最小堆，选择淘汰对象为O(log n)。
+// 被淘汰key的访问历史会在保留期(retainedPeriod个逻辑时间单位)内继续保存，再次进入缓存时恢复。
+// 所有操作在同一把锁下完成
+template<typename Key, typename Value>
+class KLruKDistanceCache : public KICachePolicy<Key, Value>
+{
+private:
+    struct Entry
+    {
+        Key                   key;
+        Value                 value;
+        std::vector<uint64_t> history;   // history[0]为最近一次访问，history[k-1]为倒数第K次，0表示没有
+        size_t                heapIndex;
+    };
+
+    struct Retained
+    {
+        Key                                   key;
+        std::vector<uint64_t>                 history;
+        typename std::multimap<uint64_t, Retained*>::iterator pos; // 在retainedOrder_中的位置
+    };
+
+    using EntryMap = std::unordered_map<KeyRef<Key>, std::unique_ptr<Entry>>;
+    using RetainedMap = std::unordered_map<KeyRef<Key>, std::unique_ptr<Retained>>;
+
+public:
+    // retainedCapacity: 最多保留多少个已淘汰key的历史；retainedPeriod: 历史最多保留多少个逻辑时间单位
+    KLruKDistanceCache(size_t capacity, int k = 2, size_t retainedCapacity = 0,
+                       uint64_t retainedPeriod = std::numeric_limits<uint64_t>::max())
+        : capacity_(capacity)
+        , k_(std::max(1, k))
+        , retainedCapacity_(retainedCapacity > 0 ? retainedCapacity : capacity)
+        , retainedPeriod_(retainedPeriod)
+        , now_(0)
+    {}
+
+    ~KLruKDistanceCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        ++now_;
+        auto it = entries_.find(KeyRef<Key>(key));
+        if (it != entries_.end())
+        {
+            it->second->value = value;
+            recordAccess(it->second.get());
+            return;
+        }
+
+        if (entries_.size() >= capacity_)
+            evict();
+
+        auto entry = std::make_unique<Entry>();
+        entry->key = key;
+        entry->value = value;
+        entry->history = takeRetainedHistory(key);
+        Entry* raw = entry.get();
+        entries_.emplace(KeyRef<Key>(raw->key), std::move(entry));
+
+        raw->heapIndex = heap_.size();
+        heap_.push_back(raw);
+        recordAccess(raw);
+        siftUp(raw->heapIndex);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(KeyRef<Key>(key));
+        if (it == entries_.end())
+            return false;
+
+        ++now_;
+        recordAccess(it->second.get());
+        value = it->second->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只读查询：不记录访问历史
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(KeyRef<Key>(key));
+        if (it == entries_.end())
+            return false;
+        value = it->second->value;
+        return true;
+    }
+
+    bool contains(Key key)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return entries_.find(KeyRef<Key>(key)) != entries_.end();
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+private:
+    // 记录一次访问：历史整体后移，history[0]写入当前时间；优先级只会变大，向下调整堆
+    void recordAccess(Entry* entry)
+    {
+        std::rotate(entry->history.rbegin(), entry->history.rbegin() + 1, entry->history.rend());
+        entry->history[0] = now_;
+        siftDown(entry->heapIndex);
+    }
+
+    void evict()
+    {
+        if (heap_.empty())
+            return;
+
+        Entry* victim = heap_[0];
+        removeFromHeap(0);
+        retainHistory(victim->key, std::move(victim->history));
+        auto it = entries_.find(KeyRef<Key>(victim->key));
+        entries_.erase(it);
+    }
+
+    // 保存被淘汰key的访问历史，并清理超出保留期或数量上限的旧历史
+    void retainHistory(const Key& key, std::vector<uint64_t> history)
+    {
+        auto retained = std::make_unique<Retained>();
+        retained->key = key;
+        retained->history = std::move(history);
+        Retained* raw = retained.get();
+        raw->pos = retainedOrder_.emplace(raw->history[0], raw);
+        retained_.emplace(KeyRef<Key>(raw->key), std::move(retained));
+
+        // 淘汰顺序与最近访问顺序不一致，按最近访问时间从早到晚清理，过期的历史不会被较新的挡住
+        while (!retainedOrder_.empty())
+        {
+            Retained* oldest = retainedOrder_.begin()->second;
+            bool expired = now_ - oldest->history[0] > retainedPeriod_;
+            if (!expired && retained_.size() <= retainedCapacity_)
+                break;
+            retainedOrder_.erase(retainedOrder_.begin());
+            auto it = retained_.find(KeyRef<Key>(oldest->key));
+            retained_.erase(it);
+        }
+    }
+
+    // 取回保留期内的历史，没有则返回全0的历史
+    std::vector<uint64_t> takeRetainedHistory(const Key& key)
+    {
+        auto it = retained_.find(KeyRef<Key>(key));
+        if (it == retained_.end())
+            return std::vector<uint64_t>(k_, 0);
+
+        std::vector<uint64_t> history = std::move(it->second->history);
+        bool expired = now_ - history[0] > retainedPeriod_;
+        retainedOrder_.erase(it->second->pos);
+        retained_.erase(it);
+        if (expired)
+            return std::vector<uint64_t>(k_, 0);
+        return history;
+    }
+
+    // 堆序：倒数第K次访问更早的排在前面；相同时(如都不足K次)按最近一次访问做LRU
+    bool evictsBefore(const Entry* a, const Entry* b) const
+    {
+        uint64_t ak = a->history[k_ - 1];
+        uint64_t bk = b->history[k_ - 1];
+        if (ak != bk)
+            return ak < bk;
+        return a->history[0] < b->history[0];
+    }
+
+    void removeFromHeap(size_t index)
+    {
+        size_t last = heap_.size() - 1;
+        if (index != last)
+        {
+            swapHeap(index, last);
+            heap_.pop_back();
+            siftDown(index);
+            siftUp(index);
+        }
+        else
+        {
+            heap_.pop_back();
+        }
+    }
+
+    void siftUp(size_t index)
+    {
+        while (index > 0)
+        {
+            size_t parent = (index - 1) / 2;
+            if (!evictsBefore(heap_[index], heap_[parent]))
+                break;
+            swapHeap(index, parent);
+            index = parent;
+        }
+    }
+
+    void siftDown(size_t index)
+    {
+        size_t size = heap_.size();
+        while (true)
+        {
+            size_t smallest = index;
+            size_t left = index * 2 + 1;
+            size_t right = left + 1;
+            if (left < size && evictsBefore(heap_[left], heap_[smallest]))
+                smallest = left;
+            if (right < size && evictsBefore(heap_[right], heap_[smallest]))
+                smallest = right;
+            if (smallest == index)
+                break;
+            swapHeap(index, smallest);
+            index = smallest;
+        }
+    }
+
+    void swapHeap(size_t a, size_t b)
+    {
+        std::swap(heap_[a], heap_[b]);
+        heap_[a]->heapIndex = a;
+        heap_[b]->heapIndex = b;
+    }
+
+private:
+    size_t                             capacity_;         // 缓存容量
+    int                                k_;                // K值
+    size_t                             retainedCapacity_; // 已淘汰key历史的数量上限
+    uint64_t                           retainedPeriod_;   // 已淘汰key历史的保留期
+    uint64_t                           now_;              // 逻辑时钟，每次访问加一
+    std::shared_mutex                  mutex_;
+    EntryMap                           entries_;          // key -> 驻留条目
+    std::vector<Entry*>                heap_;             // 按K距离组织的最小堆，堆顶为淘汰对象
+    RetainedMap                        retained_;         // key -> 已淘汰key的访问历史
+    std::multimap<uint64_t, Retained*> retainedOrder_;    // 按最近一次访问时间排列，begin为最早
+};
+
+} // namespace KamaCache
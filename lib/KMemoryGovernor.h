@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace KamaCache
+{
+
+// cgroup v2 与PSI的文件路径，测试时可指向伪造的普通文件。
+// 容器内/sys/fs/cgroup通常就是本容器的cgroup；读取失败的信号视为不可用
+struct MemorySignalPaths
+{
+    std::string current = "/sys/fs/cgroup/memory.current";
+    std::string max = "/sys/fs/cgroup/memory.max";
+    std::string pressure = "/sys/fs/cgroup/memory.pressure";
+};
+
+struct MemorySignals
+{
+    bool     hasUsage = false;    // current与max都可读且max不是"max"
+    uint64_t current = 0;         // 字节
+    uint64_t max = 0;             // 字节
+    bool     hasPressure = false;
+    double   someAvg10 = 0;       // 最近10秒至少一个任务因内存而停顿的时间占比(%)
+
+    double usageRatio() const { return hasUsage && max > 0 ? static_cast<double>(current) / max : 0.0; }
+};
+
+struct MemoryGovernorOptions
+{
+    double highUsage = 0.90;      // 用量超过该比例视为有压力
+    double lowUsage = 0.75;       // 用量低于该比例且PSI较低时才恢复
+    double highPressure = 10.0;   // some avg10超过该值(%)视为有压力
+    double lowPressure = 2.0;     // some avg10低于该值(%)才恢复
+    double shrinkStep = 0.10;     // 每次有压力时容量比例乘以(1 - shrinkStep)
+    double growStep = 0.05;       // 每次压力消退时容量比例增加growStep，不超过1
+    double minScale = 0.10;       // 容量比例下限
+    std::chrono::milliseconds interval{1000}; // 后台检查间隔
+};
+
+// 内存调控器：周期性读取cgroup v2的memory.current/memory.max与PSI的memory.pressure，
+// 有压力时把所有注册缓存的容量按同一比例逐步缩小，压力消退后逐步恢复到注册时的基准容量。
+// 每次只调整一小步，避免一次性清空缓存造成回源风暴；两组阈值之间的区间保持不变，防止来回抖动。
+// 缓存通过回调注册，任何提供setCapacity的缓存都可以接入
+class KMemoryGovernor
+{
+public:
+    using CapacitySetter = std::function<void(size_t)>;
+
+    explicit KMemoryGovernor(MemorySignalPaths paths = MemorySignalPaths(),
+                             MemoryGovernorOptions options = MemoryGovernorOptions())
+        : paths_(std::move(paths))
+        , options_(options)
+        , scale_(1.0)
+        , running_(false)
+        , stop_(false)
+    {}
+
+    ~KMemoryGovernor()
+    {
+        stop();
+    }
+
+    KMemoryGovernor(const KMemoryGovernor&) = delete;
+    KMemoryGovernor& operator=(const KMemoryGovernor&) = delete;
+
+    // baseCapacity为没有压力时的容量；注册时立即按当前比例设置一次
+    void registerCache(const std::string& name, size_t baseCapacity, CapacitySetter setCapacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        caches_.push_back(Registration{name, baseCapacity, std::move(setCapacity)});
+        apply(caches_.back());
+    }
+
+    template<typename Cache>
+    void registerCache(const std::string& name, Cache& cache, size_t baseCapacity)
+    {
+        registerCache(name, baseCapacity, [&cache](size_t capacity) { cache.setCapacity(capacity); });
+    }
+
+    // 注销后不再调整该缓存的容量，也不恢复其容量
+    void unregisterCache(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        caches_.erase(std::remove_if(caches_.begin(), caches_.end(),
+                                     [&](const Registration& r) { return r.name == name; }),
+                      caches_.end());
+    }
+
+    // 启动后台线程，按interval周期调用tick
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_)
+            return;
+        running_ = true;
+        stop_ = false;
+        worker_ = std::thread([this] { run(); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+                return;
+            stop_ = true;
+        }
+        wakeup_.notify_one();
+        worker_.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+
+    // 读取一次信号并调整容量比例，返回调整后的比例。不启动后台线程时可由调用方自行驱动
+    double tick()
+    {
+        MemorySignals signals = readSignals();
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastSignals_ = signals;
+        double scale = scale_;
+        if (underPressure(signals))
+            scale = std::max(options_.minScale, scale * (1.0 - options_.shrinkStep));
+        else if (relieved(signals))
+            scale = std::min(1.0, scale + options_.growStep);
+
+        if (scale != scale_)
+        {
+            scale_ = scale;
+            for (Registration& registration : caches_)
+                apply(registration);
+        }
+        return scale_;
+    }
+
+    double scale()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return scale_;
+    }
+
+    MemorySignals lastSignals()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lastSignals_;
+    }
+
+    MemorySignals readSignals() const
+    {
+        MemorySignals signals;
+        std::string current;
+        std::string max;
+        if (readFirstLine(paths_.current, current) && readFirstLine(paths_.max, max) && max != "max")
+        {
+            signals.current = std::strtoull(current.c_str(), nullptr, 10);
+            signals.max = std::strtoull(max.c_str(), nullptr, 10);
+            signals.hasUsage = signals.max > 0;
+        }
+
+        // 格式: some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        std::string line;
+        if (readFirstLine(paths_.pressure, line) && line.compare(0, 5, "some ") == 0)
+        {
+            size_t pos = line.find("avg10=");
+            if (pos != std::string::npos)
+            {
+                signals.someAvg10 = std::strtod(line.c_str() + pos + 6, nullptr);
+                signals.hasPressure = true;
+            }
+        }
+        return signals;
+    }
+
+private:
+    struct Registration
+    {
+        std::string    name;
+        size_t         baseCapacity;
+        CapacitySetter setCapacity;
+    };
+
+    // 调用方需持有mutex_
+    void apply(Registration& registration)
+    {
+        size_t capacity = static_cast<size_t>(registration.baseCapacity * scale_);
+        registration.setCapacity(std::max<size_t>(1, capacity));
+    }
+
+    bool underPressure(const MemorySignals& signals) const
+    {
+        return (signals.hasUsage && signals.usageRatio() >= options_.highUsage)
+            || (signals.hasPressure && signals.someAvg10 >= options_.highPressure);
+    }
+
+    // 不可用的信号不阻止恢复；两个信号都不可用时不做任何调整
+    bool relieved(const MemorySignals& signals) const
+    {
+        if (!signals.hasUsage && !signals.hasPressure)
+            return false;
+        return (!signals.hasUsage || signals.usageRatio() < options_.lowUsage)
+            && (!signals.hasPressure || signals.someAvg10 < options_.lowPressure);
+    }
+
+    static bool readFirstLine(const std::string& path, std::string& line)
+    {
+        std::ifstream in(path);
+        return in && std::getline(in, line) && !line.empty();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_)
+        {
+            lock.unlock();
+            tick();
+            lock.lock();
+            wakeup_.wait_for(lock, options_.interval, [this] { return stop_; });
+        }
+    }
+
+private:
+    MemorySignalPaths         paths_;
+    MemoryGovernorOptions     options_;
+    double                    scale_;     // 当前容量相对基准容量的比例
+    bool                      running_;
+    bool                      stop_;
+    MemorySignals             lastSignals_;
+    std::mutex                mutex_;     // 保护以上状态与caches_；容量回调在锁内调用
+    std::vector<Registration> caches_;
+    std::condition_variable   wakeup_;
+    std::thread               worker_;
+};
+
+} // namespace KamaCache
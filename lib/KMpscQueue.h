@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace KamaCache
+{
+
+// 有界无锁队列(Vyukov)：每个槽带一个序号，生产者之间只在enqueuePos_上做CAS，
+// 消费者读取时不与生产者竞争同一个计数器。这里只有一个消费者，dequeuePos_无需CAS。
+// 容量向上取整为2的幂；队列满时tryPush返回false，由调用方决定重试还是放弃
+template<typename T>
+class KMpscQueue
+{
+private:
+    struct alignas(64) Cell
+    {
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+public:
+    explicit KMpscQueue(size_t capacity)
+        : cells_(roundUpPowerOfTwo(capacity))
+        , mask_(cells_.size() - 1)
+        , enqueuePos_(0)
+        , dequeuePos_(0)
+    {
+        for (size_t i = 0; i < cells_.size(); ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    KMpscQueue(const KMpscQueue&) = delete;
+    KMpscQueue& operator=(const KMpscQueue&) = delete;
+
+    // 多个生产者线程可并发调用
+    bool tryPush(T&& value)
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.data = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // 队列已满
+            }
+            else
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 只允许唯一的消费者线程调用
+    bool tryPop(T& value)
+    {
+        Cell& cell = cells_[dequeuePos_ & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (seq != dequeuePos_ + 1)
+            return false; // 队列为空，或生产者尚未写完
+        value = std::move(cell.data);
+        cell.sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+        ++dequeuePos_;
+        return true;
+    }
+
+    size_t capacity() const { return cells_.size(); }
+
+    // 已被生产者领取的入队位置总数(含已领取但尚未写完的)，任何线程可调用
+    size_t enqueued() const { return enqueuePos_.load(std::memory_order_acquire); }
+
+    // 只允许消费者线程调用
+    bool empty() const
+    {
+        const Cell& cell = cells_[dequeuePos_ & mask_];
+        return cell.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1;
+    }
+
+private:
+    static size_t roundUpPowerOfTwo(size_t n)
+    {
+        size_t size = 2;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+private:
+    std::vector<Cell>                cells_;
+    size_t                           mask_;
+    alignas(64) std::atomic<size_t>  enqueuePos_;
+    alignas(64) size_t               dequeuePos_; // 只由消费者线程访问
+};
+
+} // namespace KamaCache
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "KICachePolicy.h"
+#include "KLruCache.h"
+
+namespace KamaCache
+{
+
+struct PrefetchStats
+{
+    size_t issued = 0;  // 预取并放入试用区的条目数
+    size_t used = 0;    // 预取后被访问到的条目数
+    size_t wasted = 0;  // 预取后未被访问就被挤出试用区的条目数
+
+    double accuracy() const { return issued == 0 ? 0.0 : static_cast<double>(used) / issued; }
+};
+
+// 顺序/定步长预取：按客户端的访问流(streamId)分别记录最近的key与步长，
+// 连续kConfirmCount次出现相同步长后，用注册的loader提前加载后续depth个key。
+// 预取结果放入单独的小容量试用区(probation)，不进入主缓存，不会挤掉热点数据；
+// 被访问到时才晋升到主缓存，未被访问就被挤出的记为浪费。
+// async为true时由后台线程加载，否则在触发预取的调用返回前同步加载
+template<typename Key, typename Value, typename Cache = KLruCache<Key, Value>>
+class KPrefetchCache : public KICachePolicy<Key, Value>
+{
+    static_assert(std::is_integral<Key>::value, "KPrefetchCache requires integral keys");
+
+public:
+    using Loader = std::function<Value(Key)>;
+
+    KPrefetchCache(int capacity, Loader loader, size_t probationCapacity = 0, int depth = 4, bool async = true)
+        : main_(capacity)
+        , loader_(std::move(loader))
+        , probationCapacity_(probationCapacity > 0 ? probationCapacity : std::max(1, capacity / 4))
+        , depth_(std::max(1, depth))
+        , async_(async)
+        , stop_(false)
+    {
+        if (async_)
+            worker_ = std::thread([this] { run(); });
+    }
+
+    ~KPrefetchCache() override
+    {
+        if (async_)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wakeup_.notify_one();
+            worker_.join();
+        }
+    }
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, 0);
+    }
+
+    void put(Key key, Value value, int streamId)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 试用区中的旧值与尚未完成的预取都作废
+            pending_.erase(key);
+            auto it = probationMap_.find(key);
+            if (it != probationMap_.end())
+            {
+                probation_.erase(it->second);
+                probationMap_.erase(it);
+            }
+            // 与promote在同一把锁内写主缓存，晋升的旧值不会覆盖这次写入
+            main_.put(key, value);
+        }
+        prefetch(observe(streamId, key));
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, 0);
+    }
+
+    // streamId区分不同客户端的访问流，各自独立检测步长
+    bool get(Key key, Value& value, int streamId)
+    {
+        bool found = main_.get(key, value);
+        if (!found)
+            found = promote(key, value);
+        prefetch(observe(streamId, key));
+        return found;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    PrefetchStats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct StreamState
+    {
+        Key     lastKey = 0;
+        int64_t stride = 0;
+        int     confidence = 0; // 连续出现相同步长的次数
+        Key     issuedUpTo = 0; // 已发起预取的最远key
+        bool    seen = false;
+        bool    issued = false;
+    };
+
+    using ProbationList = std::list<std::pair<Key, Value>>;
+
+    // 试用区命中：取出并晋升到主缓存。取出与写入在同一临界区内完成，
+    // 否则两步之间并发的put(key, 新值)会被晋升的旧值覆盖
+    bool promote(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = probationMap_.find(key);
+        if (it == probationMap_.end())
+            return false;
+        value = std::move(it->second->second);
+        probation_.erase(it->second);
+        probationMap_.erase(it);
+        ++stats_.used;
+        main_.put(key, value);
+        return true;
+    }
+
+    // 更新访问流的步长，返回需要预取的key
+    std::vector<Key> observe(int streamId, Key key)
+    {
+        std::vector<Key> candidates;
+        std::lock_guard<std::mutex> lock(mutex_);
+        StreamState& state = streams_[streamId];
+        if (!state.seen)
+        {
+            state.seen = true;
+            state.lastKey = key;
+            return candidates;
+        }
+
+        int64_t stride = static_cast<int64_t>(key) - static_cast<int64_t>(state.lastKey);
+        state.lastKey = key;
+        if (stride == 0)
+            return candidates;
+        if (stride != state.stride)
+        {
+            state.stride = stride;
+            state.confidence = 1;
+            state.issued = false;
+            return candidates;
+        }
+        if (++state.confidence < kConfirmCount)
+            return candidates;
+
+        // 只发起尚未预取过的部分
+        for (int i = 1; i <= depth_; ++i)
+        {
+            Key next = static_cast<Key>(static_cast<int64_t>(key) + stride * i);
+            if (state.issued && (stride > 0 ? next <= state.issuedUpTo : next >= state.issuedUpTo))
+                continue;
+            if (probationMap_.count(next) || pending_.count(next) || main_.contains(next))
+                continue;
+            pending_.insert(next);
+            candidates.push_back(next);
+        }
+        state.issuedUpTo = static_cast<Key>(static_cast<int64_t>(key) + stride * depth_);
+        state.issued = true;
+
+        if (async_ && !candidates.empty())
+        {
+            // 队列过长说明加载跟不上，丢弃本次预取
+            if (queue_.size() + candidates.size() > kMaxQueued)
+            {
+                for (const Key& next : candidates)
+                    pending_.erase(next);
+                candidates.clear();
+                return candidates;
+            }
+            queue_.insert(queue_.end(), candidates.begin(), candidates.end());
+            wakeup_.notify_one();
+            candidates.clear();
+        }
+        return candidates;
+    }
+
+    // 同步模式下在调用线程中加载；异步模式下candidates已交给后台线程，这里为空
+    void prefetch(const std::vector<Key>& candidates)
+    {
+        for (const Key& key : candidates)
+            load(key);
+    }
+
+    void load(const Key& key)
+    {
+        Value value{};
+        bool ok = true;
+        try
+        {
+            value = loader_(key);
+        }
+        catch (...)
+        {
+            ok = false; // 预取失败不影响正常访问
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 加载期间被put作废的预取直接丢弃
+        bool wanted = pending_.erase(key) > 0;
+        if (!ok || !wanted || probationMap_.count(key))
+            return;
+        probation_.emplace_front(key, std::move(value));
+        probationMap_.emplace(key, probation_.begin());
+        ++stats_.issued;
+        if (probation_.size() > probationCapacity_)
+        {
+            probationMap_.erase(probation_.back().first);
+            probation_.pop_back();
+            ++stats_.wasted;
+        }
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            Key key;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeup_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (stop_)
+                    return;
+                key = queue_.front();
+                queue_.pop_front();
+            }
+            load(key);
+        }
+    }
+
+private:
+    static constexpr int    kConfirmCount = 2;  // 连续两次相同步长才认为是顺序流
+    static constexpr size_t kMaxQueued = 256;
+
+    Cache                        main_;
+    Loader                       loader_;
+    size_t                       probationCapacity_;
+    int                          depth_;            // 每次向前预取的key数
+    bool                         async_;
+    bool                         stop_;
+    std::mutex                   mutex_;            // 保护以下所有成员；主缓存有自己的锁，写主缓存也在此锁内(加锁顺序 mutex_ -> 主缓存)
+    ProbationList                probation_;        // 试用区，front为最新
+    std::unordered_map<Key, typename ProbationList::iterator> probationMap_;
+    std::unordered_map<int, StreamState> streams_;
+    std::unordered_set<Key>      pending_;          // 已发起、尚未加载完成的预取
+    std::deque<Key>              queue_;            // 异步模式下等待加载的预取
+    PrefetchStats                stats_;
+    std::condition_variable      wakeup_;
+    std::thread                  worker_;
+};
+
+} // namespace KamaCache
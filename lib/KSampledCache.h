@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "KICachePolicy.h"
+#include "KKeyRef.h"
+
+namespace KamaCache
+{
+
+// 抽样淘汰的评分方式
+enum class SampledPolicy
+{
+    Lru, // 按最近一次访问的逻辑时钟，越久未访问越先淘汰
+    Lfu  // 按对数计数器(带时间衰减)，计数越小越先淘汰
+};
+
+// Redis风格的抽样淘汰引擎：条目存放在预先分配的扁平槽位数组中，不维护任何全局顺序。
+// 每个条目只有一个32位元数据：
+//   Lru模式下是最近一次访问时的32位粗粒度时钟，时钟只在插入新条目时前进，命中只读取它；
+//   Lfu模式下低8位是对数(Morris)计数器，其上16位是最近一次衰减的时间(以decayPeriod为单位)，
+//   访问次数越多计数器越难增长，长时间未访问时按经过的时间单位数衰减。
+// 命中只需共享加锁并写入条目自身的元数据，不写任何全局共享的变量；淘汰时随机抽样若干条目放入一个小的淘汰池，
+// 从池中挑选最应淘汰的条目
+template<typename Key, typename Value>
+class KSampledCache : public KICachePolicy<Key, Value>
+{
+private:
+    static constexpr uint8_t kInitCounter = 5; // Lfu模式新条目的初始计数，避免刚进入就被淘汰
+
+    struct Slot
+    {
+        Key                   key;
+        Value                 value;
+        std::atomic<uint32_t> meta{0}; // Lru: 最近访问时的时钟；Lfu: (衰减时间 << 8) | 对数计数器
+    };
+
+    struct PoolEntry
+    {
+        uint32_t idle; // 越大越应被淘汰
+        Key      key;
+    };
+
+public:
+    // samples: 每次淘汰抽样的条目数；poolSize: 淘汰池大小；
+    // logFactor/decayPeriod只用于Lfu模式：计数器增长的对数因子，以及计数器每经过多久减一
+    explicit KSampledCache(size_t capacity, SampledPolicy policy = SampledPolicy::Lru,
+                           int samples = 5, size_t poolSize = 16, int logFactor = 10,
+                           std::chrono::milliseconds decayPeriod = std::chrono::minutes(1))
+        : capacity_(capacity)
+        , policy_(policy)
+        , logFactor_(logFactor)
+        , decayPeriod_(std::max<std::chrono::milliseconds::rep>(1, decayPeriod.count()))
+        , samples_(std::max(1, samples))
+        , poolSize_(std::max<size_t>(1, poolSize))
+        , clock_(0)
+        , size_(0)
+        , slots_(capacity)
+        , gen_(std::random_device{}())
+    {
+        index_.reserve(capacity);
+    }
+
+    ~KSampledCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(KeyRef<Key>(key));
+        if (it != index_.end())
+        {
+            Slot& slot = slots_[it->second];
+            slot.value = value;
+            touch(slot);
+            return;
+        }
+
+        size_t pos = size_ < capacity_ ? size_++ : evict();
+        Slot& slot = slots_[pos];
+        slot.key = key;
+        slot.value = value;
+        slot.meta.store(initialMeta(), std::memory_order_relaxed);
+        index_.emplace(KeyRef<Key>(slot.key), pos);
+    }
+
+    // 命中只需共享加锁，元数据以原子方式更新
+    bool get(Key key, Value& value) override
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(KeyRef<Key>(key));
+        if (it == index_.end())
+            return false;
+
+        Slot& slot = slots_[it->second];
+        touch(slot);
+        value = slot.value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只读查询：不更新元数据
+    bool peek(Key key, Value& value)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(KeyRef<Key>(key));
+        if (it == index_.end())
+            return false;
+        value = slots_[it->second].value;
+        return true;
+    }
+
+    bool contains(Key key)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return index_.find(KeyRef<Key>(key)) != index_.end();
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (peek(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+private:
+    // 只在独占锁内调用：Redis的LRU时钟由定时任务推进，这里由每次插入推进
+    uint32_t initialMeta()
+    {
+        if (policy_ == SampledPolicy::Lru)
+        {
+            uint32_t now = clock_.load(std::memory_order_relaxed) + 1;
+            clock_.store(now, std::memory_order_relaxed);
+            return now;
+        }
+        return pack(currentPeriod(), kInitCounter);
+    }
+
+    // 访问一次：Lru模式只读取时钟写入条目(与条目已有值相同时不写)，两次插入之间的命中时间戳相同；
+    // Lfu模式先按经过的时间衰减，再按对数概率加一
+    void touch(Slot& slot)
+    {
+        if (policy_ == SampledPolicy::Lru)
+        {
+            uint32_t now = clock_.load(std::memory_order_relaxed);
+            if (slot.meta.load(std::memory_order_relaxed) != now)
+                slot.meta.store(now, std::memory_order_relaxed);
+            return;
+        }
+
+        uint16_t now = currentPeriod();
+        uint32_t meta = slot.meta.load(std::memory_order_relaxed);
+        uint32_t updated;
+        do
+        {
+            uint8_t counter = logIncrement(decayedCounter(meta, now));
+            updated = pack(now, counter);
+        } while (!slot.meta.compare_exchange_weak(meta, updated, std::memory_order_relaxed));
+    }
+
+    uint8_t logIncrement(uint8_t counter)
+    {
+        if (counter == 255)
+            return counter;
+        static thread_local std::mt19937 gen(std::random_device{}());
+        double r = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        double base = counter > kInitCounter ? counter - kInitCounter : 0;
+        double p = 1.0 / (base * logFactor_ + 1);
+        return r < p ? counter + 1 : counter;
+    }
+
+    static uint8_t decayedCounter(uint32_t meta, uint16_t now)
+    {
+        uint16_t last = static_cast<uint16_t>(meta >> 8);
+        uint8_t counter = static_cast<uint8_t>(meta & 0xFF);
+        uint16_t periods = static_cast<uint16_t>(now - last); // 16位时间回绕后仍按差值计算
+        return periods >= counter ? 0 : counter - periods;
+    }
+
+    static uint32_t pack(uint16_t period, uint8_t counter)
+    {
+        return (static_cast<uint32_t>(period) << 8) | counter;
+    }
+
+    uint16_t currentPeriod() const
+    {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return static_cast<uint16_t>(ms / decayPeriod_);
+    }
+
+    // 抽样填充淘汰池，取出池中idle最大且仍在缓存中的条目，返回其槽位供新条目复用
+    size_t evict()
+    {
+        while (true)
+        {
+            populatePool();
+            while (!pool_.empty())
+            {
+                PoolEntry candidate = std::move(pool_.back());
+                pool_.pop_back();
+                auto it = index_.find(KeyRef<Key>(candidate.key));
+                if (it == index_.end())
+                    continue; // 池中的候选已被淘汰过
+                size_t pos = it->second;
+                index_.erase(it);
+                return pos;
+            }
+        }
+    }
+
+    // Lru: 距今经过的时钟数(无符号减法可处理32位回绕)；Lfu: 255 - 衰减后的计数
+    uint32_t idleScore(uint32_t meta, uint32_t clock, uint16_t period) const
+    {
+        if (policy_ == SampledPolicy::Lru)
+            return clock - meta;
+        return 255 - decayedCounter(meta, period);
+    }
+
+    // 淘汰池按idle升序排列，末尾是最应淘汰的候选
+    void populatePool()
+    {
+        uint32_t clock = clock_.load(std::memory_order_relaxed);
+        uint16_t period = currentPeriod();
+        std::uniform_int_distribution<size_t> dist(0, size_ - 1);
+        for (int i = 0; i < samples_; ++i)
+        {
+            const Slot& slot = slots_[dist(gen_)];
+            uint32_t idle = idleScore(slot.meta.load(std::memory_order_relaxed), clock, period);
+
+            auto same = std::find_if(pool_.begin(), pool_.end(),
+                [&](const PoolEntry& entry) { return entry.key == slot.key; });
+            if (same != pool_.end())
+                pool_.erase(same);
+            if (pool_.size() >= poolSize_)
+            {
+                if (idle <= pool_.front().idle)
+                    continue;
+                pool_.erase(pool_.begin());
+            }
+            auto pos = std::upper_bound(pool_.begin(), pool_.end(), idle,
+                [](uint32_t value, const PoolEntry& entry) { return value < entry.idle; });
+            pool_.insert(pos, PoolEntry{idle, slot.key});
+        }
+    }
+
+private:
+    size_t                                  capacity_;
+    SampledPolicy                           policy_;
+    int                                     logFactor_;
+    std::chrono::milliseconds::rep          decayPeriod_; // 衰减时间单位(毫秒)
+    int                                     samples_;
+    size_t                                  poolSize_;
+    std::atomic<uint32_t>                   clock_;       // Lru模式的粗粒度时钟，每次插入加一，命中只读
+    size_t                                  size_;        // slots_中前size_个槽位已被使用
+    std::vector<Slot>                       slots_;       // 预先分配的扁平槽位数组
+    std::unordered_map<KeyRef<Key>, size_t> index_;       // key -> 槽位下标
+    std::vector<PoolEntry>                  pool_;        // 淘汰池
+    std::mt19937                            gen_;         // 抽样用，只在独占锁内使用
+    std::shared_mutex                       mutex_;       // 命中共享加锁，插入与淘汰独占加锁
+};
+
+// Redis风格的近似LFU：8位对数计数器 + 时间衰减 + 抽样淘汰池，不维护按频次分组的链表
+template<typename Key, typename Value>
+class KLfuLogCache : public KSampledCache<Key, Value>
+{
+public:
+    explicit KLfuLogCache(size_t capacity, int logFactor = 10,
+                          std::chrono::milliseconds decayPeriod = std::chrono::minutes(1),
+                          int samples = 5, size_t poolSize = 16)
+        : KSampledCache<Key, Value>(capacity, SampledPolicy::Lfu, samples, poolSize, logFactor, decayPeriod)
+    {}
+};
+
+} // namespace KamaCache
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "KICachePolicy.h"
+
+namespace KamaCache
+{
+
+// 只读快照缓存：适用于"每隔几分钟整体重建一次、读取极其频繁"的数据。
+// 数据被批量构建成按hash排序的扁平表，以RCU的方式整体替换指针发布。
+// 读者不加锁，只在自己的读者槽上做一次计数，步数固定(wait-free)；
+// 写者发布新表后等待旧表上的读者全部退出(宽限期)，再回收旧表。
+template<typename Key, typename Value>
+class KSnapshotCache : public KICachePolicy<Key, Value>
+{
+private:
+    struct Entry
+    {
+        size_t hash;
+        Key    key;
+        Value  value;
+    };
+
+    struct Table
+    {
+        std::vector<Entry> entries; // 按hash升序排列
+    };
+
+    // 每个读者槽独占一条缓存行，避免读者之间互相抢占同一计数器
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<size_t> count[2] = {{0}, {0}};
+    };
+
+    static constexpr size_t kReaderSlots = 64;
+
+public:
+    KSnapshotCache()
+        : table_(new Table())
+        , epoch_(0)
+    {}
+
+    template<typename InputIt>
+    KSnapshotCache(InputIt first, InputIt last)
+        : KSnapshotCache()
+    {
+        rebuild(first, last);
+    }
+
+    ~KSnapshotCache() override
+    {
+        delete table_.load();
+    }
+
+    // 用一批(key, value)重建整张表并发布，重复的key以最后出现的为准
+    template<typename InputIt>
+    void rebuild(InputIt first, InputIt last)
+    {
+        Table* table = new Table();
+        for (; first != last; ++first)
+        {
+            table->entries.push_back({Hash(first->first), first->first, first->second});
+        }
+        sortAndDeduplicate(table->entries);
+
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        publish(table);
+    }
+
+    // 写时复制：复制当前整张表再发布，代价为O(n)，只适合零星更新
+    void put(Key key, Value value) override
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        Table* table = new Table(*table_.load());
+        size_t hash = Hash(key);
+        auto& entries = table->entries;
+        auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+            [](const Entry& entry, size_t h) { return entry.hash < h; });
+        for (auto cur = it; cur != entries.end() && cur->hash == hash; ++cur)
+        {
+            if (cur->key == key)
+            {
+                cur->value = value;
+                publish(table);
+                return;
+            }
+        }
+        entries.insert(it, Entry{hash, key, value});
+        publish(table);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        ReaderSlot& slot = readerSlot();
+        size_t parity = epoch_.load() & 1;
+        slot.count[parity].fetch_add(1);
+
+        const Entry* entry = find(*table_.load(), key);
+        if (entry)
+        {
+            value = entry->value;
+        }
+
+        slot.count[parity].fetch_sub(1);
+        return entry != nullptr;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 快照表没有需要维护的访问元数据，只读查询与get等价
+    bool peek(Key key, Value& value)
+    {
+        return get(key, value);
+    }
+
+    bool contains(Key key)
+    {
+        Value value{};
+        return get(key, value);
+    }
+
+    std::optional<Value> getIfPresentQuiet(Key key)
+    {
+        Value value{};
+        if (get(key, value))
+            return value;
+        return std::nullopt;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return table_.load()->entries.size();
+    }
+
+private:
+    // 发布新表并回收旧表，调用方需持有writeMutex_
+    void publish(Table* table)
+    {
+        Table* old = table_.exchange(table);
+        synchronize();
+        delete old;
+    }
+
+    // 宽限期：翻转两次epoch，每次等待上一个epoch的读者全部退出。
+    // 翻转两次是为了覆盖"读到旧epoch后被挂起、之后才计数"的读者。
+    void synchronize()
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            size_t parity = epoch_.fetch_add(1) & 1;
+            for (auto& slot : readerSlots_)
+            {
+                while (slot.count[parity].load() != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    ReaderSlot& readerSlot()
+    {
+        static thread_local size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % kReaderSlots;
+        return readerSlots_[index];
+    }
+
+    static const Entry* find(const Table& table, const Key& key)
+    {
+        size_t hash = Hash(key);
+        auto it = std::lower_bound(table.entries.begin(), table.entries.end(), hash,
+            [](const Entry& entry, size_t h) { return entry.hash < h; });
+        for (; it != table.entries.end() && it->hash == hash; ++it)
+        {
+            if (it->key == key)
+                return &*it;
+        }
+        return nullptr;
+    }
+
+    static void sortAndDeduplicate(std::vector<Entry>& entries)
+    {
+        // 稳定排序保证相同key保持输入顺序，随后保留每个key最后一次出现的值
+        std::stable_sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+        std::vector<Entry> result;
+        result.reserve(entries.size());
+        for (auto& entry : entries)
+        {
+            auto it = std::find_if(result.rbegin(), result.rend(),
+                [&](const Entry& e) { return e.hash != entry.hash || e.key == entry.key; });
+            if (it != result.rend() && it->hash == entry.hash && it->key == entry.key)
+                it->value = std::move(entry.value);
+            else
+                result.push_back(std::move(entry));
+        }
+        entries.swap(result);
+    }
+
+    static size_t Hash(const Key& key)
+    {
+        std::hash<Key> hashFunc;
+        return hashFunc(key);
+    }
+
+private:
+    std::atomic<Table*>     table_;      // 当前发布的表
+    std::atomic<size_t>     epoch_;      // 读者按其奇偶选择计数槽
+    ReaderSlot              readerSlots_[kReaderSlots];
+    std::mutex              writeMutex_; // 串行化写者
+};
+
+} // namespace KamaCache
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "KICachePolicy.h"
+#include "KLockPolicy.h"
+#include "KLruCache.h"
+
+namespace KamaCache
+{
+
+struct TtlStats
+{
+    size_t hits = 0;           // 未过期命中
+    size_t misses = 0;         // 不存在或已过期，调用方需要等待加载
+    size_t loads = 0;          // 实际调用loader的次数
+    size_t earlyRefreshes = 0; // 过期前被提前刷新的次数
+    size_t staleHits = 0;      // 返回过期值并在后台刷新(stale-while-revalidate)
+    size_t staleOnError = 0;   // 加载失败时返回过期值(stale-if-error)
+};
+
+// 过期条目的处理方式。两个时间窗口都从条目过期时刻算起，均为0时过期条目直接丢弃
+struct TtlStaleOptions
+{
+    std::chrono::steady_clock::duration whileRevalidate{}; // 窗口内直接返回过期值，同时由后台线程刷新
+    std::chrono::steady_clock::duration ifError{};         // 窗口内加载失败时返回过期值而不是抛出异常
+    int capacity = 0;                                      // 过期区容量，0表示主容量的1/4
+};
+
+// 带过期时间的读穿透缓存，容量满时按LRU淘汰。
+// 每个条目记录过期时刻与上次加载耗时delta，getOrLoad按XFetch规则提前刷新：
+// 当 now - delta * beta * ln(rand()) >= expireAt 时由当前调用方重新加载。
+// 加载越慢、离过期越近，提前刷新的概率越大；各调用方独立抽签，不需要全局协调，
+// 热点条目通常在过期前就被某一个调用方刷新，不会在过期瞬间所有调用方同时回源。
+// 同一key同时只有一次加载，提前刷新期间其他调用方继续读旧值，已过期的调用方等待加载结果。
+// beta越大越早刷新，beta为0时关闭提前刷新。
+// 过期条目移入单独的小容量过期区(按LRU淘汰)，不占用主容量，按TtlStaleOptions继续提供旧值
+template<typename Key, typename Value>
+class KTtlCache : public KICachePolicy<Key, Value>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Loader = std::function<Value(Key)>;
+
+    KTtlCache(int capacity, Clock::duration ttl, Loader loader, double beta = 1.0,
+              TtlStaleOptions staleOptions = TtlStaleOptions())
+        : entries_(capacity)
+        , staleEntries_(staleOptions.capacity > 0 ? staleOptions.capacity : std::max(1, capacity / 4))
+        , ttl_(ttl)
+        , loader_(std::move(loader))
+        , beta_(beta)
+        , staleOptions_(staleOptions)
+        , stop_(false)
+    {
+        if (staleOptions_.whileRevalidate > Clock::duration::zero())
+            worker_ = std::thread([this] { run(); });
+    }
+
+    ~KTtlCache() override
+    {
+        if (worker_.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wakeup_.notify_one();
+            worker_.join();
+        }
+    }
+
+    void put(Key key, Value value) override
+    {
+        put(key, std::move(value), ttl_);
+    }
+
+    // 沿用已有条目记录的加载耗时，以便之后仍能提前刷新。
+    // 该key正在加载(含提前刷新与后台刷新)时，加载结果比这次写入旧，加载完成后不再写入缓存
+    void put(Key key, Value value, Clock::duration ttl)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry entry;
+        Clock::duration delta = entries_.get(key, entry) ? entry.delta : Clock::duration::zero();
+        entries_.put(key, Entry{std::move(value), Clock::now() + ttl, delta});
+        staleEntries_.remove(key);
+        supersede(key);
+    }
+
+    // 只读查询：只返回未过期的值，不触发加载
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry entry;
+        if (!entries_.get(key, entry) || Clock::now() >= entry.expireAt)
+            return false;
+        value = std::move(entry.value);
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        return getOrLoad(key);
+    }
+
+    // 读穿透：未过期直接返回(可能顺带提前刷新)；过期值仍在whileRevalidate窗口内时返回过期值并在后台刷新；
+    // 否则等待加载，加载失败时在ifError窗口内返回过期值，再之外把loader的异常抛给所有等待该key的调用方
+    Value getOrLoad(const Key& key)
+    {
+        std::promise<Value> promise;
+        std::shared_future<Value> waitFor;
+        Entry entry;
+        bool early = false;
+        bool stale = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Clock::time_point now = Clock::now();
+            bool found = entries_.get(key, entry);
+            auto it = inflight_.find(key);
+            if (found && now < entry.expireAt)
+            {
+                ++stats_.hits;
+                if (it != inflight_.end() || !shouldRefreshEarly(entry, now))
+                    return entry.value;
+                early = true;
+                ++stats_.earlyRefreshes;
+            }
+            else
+            {
+                if (found)
+                    retire(key, entry);
+                stale = findStale(key, now, entry);
+                if (stale && now < entry.expireAt + staleOptions_.whileRevalidate)
+                {
+                    ++stats_.staleHits;
+                    if (it == inflight_.end())
+                        scheduleRefresh(key);
+                    return entry.value;
+                }
+                ++stats_.misses;
+                if (it != inflight_.end())
+                    waitFor = it->second.result;
+            }
+            if (!waitFor.valid())
+            {
+                inflight_.emplace(key, InFlight{promise.get_future().share()});
+                ++stats_.loads;
+            }
+        }
+
+        try
+        {
+            if (waitFor.valid())
+                return waitFor.get();
+            return load(key, promise);
+        }
+        catch (...)
+        {
+            // 提前刷新失败时旧值仍在有效期内
+            if (early)
+                return entry.value;
+            if (stale && Clock::now() < entry.expireAt + staleOptions_.ifError)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++stats_.staleOnError;
+                return entry.value;
+            }
+            throw;
+        }
+    }
+
+    // 同put，正在进行的加载完成后不会把旧结果写回
+    void remove(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.remove(key);
+        staleEntries_.remove(key);
+        supersede(key);
+    }
+
+    TtlStats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Entry
+    {
+        Value             value{};
+        Clock::time_point expireAt{};
+        Clock::duration   delta{}; // 上次加载耗时
+    };
+
+    struct InFlight
+    {
+        std::shared_future<Value> result;
+        bool                      superseded = false; // 加载期间该key被put或remove过
+    };
+
+    // 调用loader并写入结果，完成promise；失败时把异常交给promise后重新抛出。
+    // 加载期间被put抢先时不写入，等待者拿到的是put写入的值(被remove时为加载的值)
+    Value load(const Key& key, std::promise<Value>& promise)
+    {
+        Value value{};
+        Clock::time_point start = Clock::now();
+        try
+        {
+            value = loader_(key);
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(mutex_);
+            inflight_.erase(key);
+            throw;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = inflight_.find(key);
+            if (it != inflight_.end() && it->second.superseded)
+            {
+                Entry current;
+                if (entries_.get(key, current))
+                    value = std::move(current.value);
+            }
+            else
+            {
+                Clock::time_point now = Clock::now();
+                entries_.put(key, Entry{value, now + ttl_, now - start});
+                staleEntries_.remove(key);
+            }
+            inflight_.erase(key);
+        }
+        promise.set_value(value);
+        return value;
+    }
+
+    // 标记该key正在进行的加载已过时。调用方需持有mutex_
+    void supersede(const Key& key)
+    {
+        auto it = inflight_.find(key);
+        if (it != inflight_.end())
+            it->second.superseded = true;
+    }
+
+    // 过期条目移出主区；仍可能被使用时放入过期区。调用方需持有mutex_
+    void retire(const Key& key, const Entry& entry)
+    {
+        entries_.remove(key);
+        if (staleWindow() > Clock::duration::zero())
+            staleEntries_.put(key, entry);
+    }
+
+    // 查找仍在窗口内的过期值，超出窗口的顺便删除。调用方需持有mutex_
+    bool findStale(const Key& key, Clock::time_point now, Entry& entry)
+    {
+        if (!staleEntries_.get(key, entry))
+            return false;
+        if (now < entry.expireAt + staleWindow())
+            return true;
+        staleEntries_.remove(key);
+        return false;
+    }
+
+    Clock::duration staleWindow() const
+    {
+        return std::max(staleOptions_.whileRevalidate, staleOptions_.ifError);
+    }
+
+    // 交给后台线程刷新。调用方需持有mutex_
+    void scheduleRefresh(const Key& key)
+    {
+        std::promise<Value> promise;
+        inflight_.emplace(key, InFlight{promise.get_future().share()});
+        refreshQueue_.emplace_back(key, std::move(promise));
+        ++stats_.loads;
+        wakeup_.notify_one();
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            std::pair<Key, std::promise<Value>> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeup_.wait(lock, [this] { return stop_ || !refreshQueue_.empty(); });
+                if (stop_)
+                    return;
+                task = std::move(refreshQueue_.front());
+                refreshQueue_.pop_front();
+            }
+            try
+            {
+                load(task.first, task.second);
+            }
+            catch (...)
+            {
+                // 刷新失败时过期值保留在过期区，等待方按ifError窗口处理
+            }
+        }
+    }
+
+    bool shouldRefreshEarly(const Entry& entry, Clock::time_point now) const
+    {
+        if (beta_ <= 0 || entry.delta <= Clock::duration::zero())
+            return false;
+        // 每个线程独立的随机数，调用方之间不需要同步；取(0,1]避免ln(0)
+        thread_local std::mt19937_64 rng(std::random_device{}());
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        double gap = -entry.delta.count() * beta_ * std::log(1.0 - dist(rng));
+        return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, Clock::period>(gap))
+            >= entry.expireAt;
+    }
+
+private:
+    KLruCache<Key, Entry, KNullLock>                entries_;      // 由mutex_保护，内部不再加锁
+    KLruCache<Key, Entry, KNullLock>                staleEntries_; // 过期区，不计入主容量
+    Clock::duration                                 ttl_;
+    Loader                                          loader_;
+    double                                          beta_;
+    TtlStaleOptions                                 staleOptions_;
+    bool                                            stop_;
+    std::mutex                                      mutex_;
+    std::unordered_map<Key, InFlight>               inflight_;     // 正在加载的key
+    std::deque<std::pair<Key, std::promise<Value>>> refreshQueue_; // 等待后台刷新的key
+    TtlStats                                        stats_;
+    std::condition_variable                         wakeup_;
+    std::thread                                     worker_;
+};
+
+} // namespace KamaCache
@@ -3,13 +3,49 @@
 #include <chrono>
 #include <vector>
 #include <iomanip>
+#include <numeric>
 #include <random>
+#include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 #include "KICachePolicy.h"
+#include "KBeladyOracle.h"
 #include "KLfuCache.h"
+#include "KLockPolicy.h"
 #include "KLruCache.h"
 #include "KArcCache/KArcCache.h"
+#include "KCacheBalancer.h"
+#include "KCarCache.h"
+#include "KConcurrentLruCache.h"
+#include "KDelegatedLruCaches.h"
+#include "KLruKDistanceCache.h"
+#include "KMemoryGovernor.h"
+#include "KPrefetchCache.h"
+#include "KHugePageArena.h"
+#include "KHyperbolicCache.h"
+#include "KSampledCache.h"
+#include "KSnapshotCache.h"
+#include "KTtlCache.h"
 
 class Timer {
 public:
@@ -24,23 +60,14 @@ private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start_;
 };
 
-// 辅助函数：打印结果
+// 辅助函数：打印结果，names与hits一一对应
 void printResults(const std::string& testName, int capacity, 
+                 const std::vector<std::string>& names,
                  const std::vector<int>& get_operations, 
                  const std::vector<int>& hits) {
     std::cout << "=== " << testName << " 结果汇总 ===" << std::endl;
     std::cout << "缓存大小: " << capacity << std::endl;
     
-    // 假设对应的算法名称已在测试函数中定义
-    std::vector<std::string> names;
-    if (hits.size() == 3) {
-        names = {"LRU", "LFU", "ARC"};
-    } else if (hits.size() == 4) {
-        names = {"LRU", "LFU", "ARC", "LRU-K"};
-    } else if (hits.size() == 5) {
-        names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
-    }
-    
     for (size_t i = 0; i < hits.size(); ++i) {
         double hitRate = 100.0 * hits[i] / get_operations[i];
         std::cout << (i < names.size() ? names[i] : "Algorithm " + std::to_string(i+1)) 
@@ -70,18 +97,23 @@ void testHotDataAccess() {
     // - k=2表示数据被访问2次后才会进入缓存，适合区分热点和冷数据
     KamaCache::KLruKCache<int, std::string> lruk(CAPACITY, HOT_KEYS + COLD_KEYS, 2);
     KamaCache::KLfuCache<int, std::string> lfuAging(CAPACITY, 20000);
+    KamaCache::KArcCache<int, std::string> arcClassic(CAPACITY, 2, KamaCache::ArcMode::Classic);
+    // 真正的LRU-K：按倒数第2次访问时间淘汰，历史保留容量与LRU-K相同
+    KamaCache::KLruKDistanceCache<int, std::string> lrukDist(CAPACITY, 2, HOT_KEYS + COLD_KEYS);
+    KamaCache::KLfuLogCache<int, std::string> lfuLog(CAPACITY);
+    KamaCache::KSampledCache<int, std::string> lruSampled(CAPACITY, KamaCache::SampledPolicy::Lru);
 
     std::random_device rd;
     std::mt19937 gen(rd());
     
     // 基类指针指向派生类对象，添加LFU-Aging
-    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::vector<KamaCache::KICachePolicy<int, std::string>*> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &arcClassic, &lrukDist, &lfuLog, &lruSampled};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "ARC-Classic", "LRU-K-Dist", "LFU-Log", "LRU-Sampled"};
 
     // 为所有的缓存对象进行相同的操作序列测试
-    for (int i = 0; i < caches.size(); ++i) {
+    for (size_t i = 0; i < caches.size(); ++i) {
         // 先预热缓存，插入一些数据
         for (int key = 0; key < HOT_KEYS; ++key) {
             std::string value = "value" + std::to_string(key);
@@ -118,7 +150,7 @@ void testHotDataAccess() {
     }
 
     // 打印测试结果
-    printResults("热点数据访问测试", CAPACITY, get_operations, hits);
+    printResults("热点数据访问测试", CAPACITY, names, get_operations, hits);
 }
 
 void testLoopPattern() {
@@ -136,17 +168,24 @@ void testLoopPattern() {
     // - k=2，对于循环访问，这是一个合理的阈值
     KamaCache::KLruKCache<int, std::string> lruk(CAPACITY, LOOP_SIZE * 2, 2);
     KamaCache::KLfuCache<int, std::string> lfuAging(CAPACITY, 3000);
+    KamaCache::KArcCache<int, std::string> arcClassic(CAPACITY, 2, KamaCache::ArcMode::Classic);
+    KamaCache::KLruKDistanceCache<int, std::string> lrukDist(CAPACITY, 2, LOOP_SIZE * 2);
+    KamaCache::KLfuLogCache<int, std::string> lfuLog(CAPACITY);
+    KamaCache::KSampledCache<int, std::string> lruSampled(CAPACITY, KamaCache::SampledPolicy::Lru);
+    // 同步预取，保证测试结果可复现；试用区容量为主缓存的1/4
+    KamaCache::KPrefetchCache<int, std::string> lruPrefetch(CAPACITY,
+        [](int key) { return "loop" + std::to_string(key); }, 0, 4, false);
 
-    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::vector<KamaCache::KICachePolicy<int, std::string>*> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &arcClassic, &lrukDist, &lfuLog, &lruSampled, &lruPrefetch};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "ARC-Classic", "LRU-K-Dist", "LFU-Log", "LRU-Sampled", "LRU+Prefetch"};
 
     std::random_device rd;
     std::mt19937 gen(rd());
 
     // 为每种缓存算法运行相同的测试
-    for (int i = 0; i < caches.size(); ++i) {
+    for (size_t i = 0; i < caches.size(); ++i) {
         // 先预热一部分数据（只加载20%的数据）
         for (int key = 0; key < LOOP_SIZE / 5; ++key) {
             std::string value = "loop" + std::to_string(key);
@@ -187,7 +226,11 @@ void testLoopPattern() {
         }
     }
 
-    printResults("循环扫描测试", CAPACITY, get_operations, hits);
+    printResults("循环扫描测试", CAPACITY, names, get_operations, hits);
+    KamaCache::PrefetchStats prefetchStats = lruPrefetch.stats();
+    std::cout << "LRU+Prefetch 预取: " << prefetchStats.issued << ", 命中: " << prefetchStats.used
+              << ", 浪费: " << prefetchStats.wasted << ", 准确率: " << std::fixed << std::setprecision(2)
+              << 100.0 * prefetchStats.accuracy() << "%" << std::endl;
 }
 
 void testWorkloadShift() {
@@ -202,16 +245,22 @@ void testWorkloadShift() {
     KamaCache::KArcCache<int, std::string> arc(CAPACITY);
     KamaCache::KLruKCache<int, std::string> lruk(CAPACITY, 500, 2);
     KamaCache::KLfuCache<int, std::string> lfuAging(CAPACITY, 10000);
+    KamaCache::KArcCache<int, std::string> arcClassic(CAPACITY, 2, KamaCache::ArcMode::Classic);
+    KamaCache::KLruKDistanceCache<int, std::string> lrukDist(CAPACITY, 2, 500);
+    KamaCache::KLfuLogCache<int, std::string> lfuLog(CAPACITY);
+    KamaCache::KSampledCache<int, std::string> lruSampled(CAPACITY, KamaCache::SampledPolicy::Lru);
+    KamaCache::KCarCache<int, std::string> car(CAPACITY);
+    KamaCache::KHyperbolicCache<int, std::string> hyperbolic(CAPACITY);
 
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::vector<KamaCache::KICachePolicy<int, std::string>*> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &arcClassic, &lrukDist, &lfuLog, &lruSampled, &car, &hyperbolic};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "ARC-Classic", "LRU-K-Dist", "LFU-Log", "LRU-Sampled", "CAR", "Hyperbolic"};
 
     // 为每种缓存算法运行相同的测试
-    for (int i = 0; i < caches.size(); ++i) { 
+    for (size_t i = 0; i < caches.size(); ++i) { 
         // 先预热缓存，只插入少量初始数据
         for (int key = 0; key < 30; ++key) {
             std::string value = "init" + std::to_string(key);
@@ -275,12 +324,1439 @@ void testWorkloadShift() {
         }
     }
 
-    printResults("工作负载剧烈变化测试", CAPACITY, get_operations, hits);
+    printResults("工作负载剧烈变化测试", CAPACITY, names, get_operations, hits);
+}
+
+// 锁策略基准：同一个KLruCache分别使用不同的锁，统计get/put混合操作的耗时。
+// threads为1时包含空锁；多线程时空锁不安全，跳过
+template<typename Lock>
+void benchLockPolicy(const std::string& name, int threads, int opsPerThread) {
+    const int CAPACITY = 1000;
+    const int KEY_RANGE = 2000;
+    KamaCache::KLruCache<int, std::string, Lock> cache(CAPACITY);
+    for (int key = 0; key < CAPACITY; ++key) {
+        cache.put(key, "value" + std::to_string(key));
+    }
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, t, opsPerThread]() {
+            std::mt19937 gen(t);
+            std::string value;
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = gen() % KEY_RANGE;
+                if (gen() % 100 < 20) {
+                    cache.put(key, "value" + std::to_string(key));
+                } else {
+                    cache.get(key, value);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double ms = std::max(1.0, timer.elapsed());
+    std::cout << std::fixed << std::setprecision(0) << name << " - 耗时: " << ms << "ms, 吞吐: "
+              << (threads * static_cast<double>(opsPerThread)) / ms * 1000 << " ops/s" << std::endl;
+}
+
+void testLockPolicies() {
+    std::cout << "\n=== 测试场景4：锁策略对比 ===" << std::endl;
+    const int OPERATIONS = 200000;
+    int threads = std::max(2u, std::thread::hardware_concurrency());
+
+    std::cout << "--- 单线程 ---" << std::endl;
+    benchLockPolicy<KamaCache::KNullLock>("NullLock", 1, OPERATIONS);
+    benchLockPolicy<KamaCache::KMutexLock>("Mutex", 1, OPERATIONS);
+    benchLockPolicy<KamaCache::KSpinLock>("SpinLock", 1, OPERATIONS);
+    benchLockPolicy<std::shared_mutex>("SharedMutex", 1, OPERATIONS);
+    benchLockPolicy<KamaCache::KAdaptiveLock>("AdaptiveLock", 1, OPERATIONS);
+
+    std::cout << "--- " << threads << " 线程 ---" << std::endl;
+    benchLockPolicy<KamaCache::KMutexLock>("Mutex", threads, OPERATIONS / threads);
+    benchLockPolicy<KamaCache::KSpinLock>("SpinLock", threads, OPERATIONS / threads);
+    benchLockPolicy<std::shared_mutex>("SharedMutex", threads, OPERATIONS / threads);
+    benchLockPolicy<KamaCache::KAdaptiveLock>("AdaptiveLock", threads, OPERATIONS / threads);
+    std::cout << std::endl;
+}
+
+// 多个线程反复读取少量热点key，条目同时写入、同时过期。
+// 对比关闭提前刷新(beta=0)、XFetch提前刷新与过期值处理时，回源次数、因过期而阻塞等待加载的请求数，
+// 以及failPercent%的加载失败中有多少最终抛给了调用方
+void runTtlStampede(const std::string& name, double beta, KamaCache::TtlStaleOptions staleOptions = {},
+                    int failPercent = 0) {
+    const int HOT_KEYS = 8;
+    const auto TTL = std::chrono::milliseconds(50);
+    const auto LOAD_TIME = std::chrono::milliseconds(5);
+    const auto DURATION = std::chrono::milliseconds(400);
+    int threads = std::max(4u, std::thread::hardware_concurrency());
+
+    std::atomic<int> loadCount(0);
+    KamaCache::KTtlCache<int, std::string> cache(HOT_KEYS, TTL, [&](int key) {
+        std::this_thread::sleep_for(LOAD_TIME);
+        // 前几次加载总是成功，保证每个key都有值；之后每100次加载中连续失败failPercent次
+        int count = ++loadCount;
+        if (count > HOT_KEYS && count % 100 < failPercent) {
+            throw std::runtime_error("backend error");
+        }
+        return "value" + std::to_string(key);
+    }, beta, staleOptions);
+
+    auto deadline = std::chrono::steady_clock::now() + DURATION;
+    std::atomic<int> errors(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, &deadline, &errors, t]() {
+            std::mt19937 gen(t);
+            while (std::chrono::steady_clock::now() < deadline) {
+                try {
+                    cache.getOrLoad(gen() % HOT_KEYS);
+                } catch (const std::exception&) {
+                    errors++;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    KamaCache::TtlStats stats = cache.stats();
+    std::cout << name << " - 请求: " << stats.hits + stats.misses + stats.staleHits << ", 回源: " << stats.loads
+              << ", 提前刷新: " << stats.earlyRefreshes << ", 过期阻塞: " << stats.misses
+              << ", 返回过期值: " << stats.staleHits + stats.staleOnError << ", 错误: " << errors << std::endl;
+}
+
+void testTtlStampede() {
+    std::cout << "\n=== 测试场景5：TTL过期回源测试 ===" << std::endl;
+    runTtlStampede("TTL", 0.0);
+    runTtlStampede("TTL+XFetch", 1.0);
+
+    // 热点key同时过期，过期区要能容纳全部热点key
+    KamaCache::TtlStaleOptions swr;
+    swr.whileRevalidate = std::chrono::milliseconds(100);
+    swr.capacity = 8;
+    runTtlStampede("TTL+SWR", 0.0, swr);
+
+    std::cout << "--- 20% 加载失败 ---" << std::endl;
+    KamaCache::TtlStaleOptions sie;
+    sie.ifError = std::chrono::seconds(1);
+    sie.capacity = 8;
+    runTtlStampede("TTL", 0.0, {}, 20);
+    runTtlStampede("TTL+StaleIfError", 0.0, sie, 20);
+    std::cout << std::endl;
+}
+
+// 用临时文件伪造cgroup的memory.current/memory.max与PSI，模拟内存压力先上升后消退，
+// 观察调控器逐步缩小并恢复LRU与分片LFU的容量
+void testMemoryGovernor() {
+    std::cout << "\n=== 测试场景6：内存压力调控测试 ===" << std::endl;
+    char dir[] = "/tmp/kamacache_cgroupXXXXXX";
+    if (!mkdtemp(dir)) {
+        std::cerr << "无法创建临时目录" << std::endl;
+        return;
+    }
+    KamaCache::MemorySignalPaths paths;
+    paths.current = std::string(dir) + "/memory.current";
+    paths.max = std::string(dir) + "/memory.max";
+    paths.pressure = std::string(dir) + "/memory.pressure";
+    auto writeSignals = [&paths](uint64_t currentMb, double someAvg10) {
+        std::ofstream(paths.current) << currentMb * 1024 * 1024 << "\n";
+        std::ofstream(paths.max) << 1024ull * 1024 * 1024 << "\n";
+        std::ofstream(paths.pressure) << "some avg10=" << someAvg10 << " avg60=0.00 avg300=0.00 total=0\n"
+                                      << "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+    };
+
+    const int CAPACITY = 1000;
+    KamaCache::KLruCache<int, std::string> lru(CAPACITY);
+    KamaCache::KHashLfuCache<int, std::string> lfu(CAPACITY, 4);
+    for (int key = 0; key < CAPACITY; ++key) {
+        lru.put(key, "value" + std::to_string(key));
+        lfu.put(key, "value" + std::to_string(key));
+    }
+
+    KamaCache::KMemoryGovernor governor(paths);
+    governor.registerCache("lru", lru, CAPACITY);
+    governor.registerCache("lfu", lfu, CAPACITY);
+
+    // 用量(MB, 上限1024MB)与PSI some avg10随时间的变化：先升高，再回落
+    std::vector<std::pair<uint64_t, double>> timeline = {
+        {600, 0.0}, {950, 4.0}, {980, 15.0}, {990, 25.0}, {970, 12.0},
+        {800, 5.0}, {700, 1.0}, {600, 0.5}, {600, 0.0}, {600, 0.0}};
+    for (size_t step = 0; step < timeline.size(); ++step) {
+        writeSignals(timeline[step].first, timeline[step].second);
+        double scale = governor.tick();
+        int lruResident = 0;
+        int lfuResident = 0;
+        for (int key = 0; key < CAPACITY; ++key) {
+            lruResident += lru.contains(key);
+            lfuResident += lfu.contains(key);
+        }
+        std::cout << "第" << step + 1 << "次 - 用量: " << timeline[step].first << "MB, PSI: "
+                  << std::fixed << std::setprecision(1) << timeline[step].second
+                  << "%, 容量比例: " << std::setprecision(2) << scale
+                  << ", LRU驻留: " << lruResident << ", LFU驻留: " << lfuResident << std::endl;
+    }
+
+    std::remove(paths.current.c_str());
+    std::remove(paths.max.c_str());
+    std::remove(paths.pressure.c_str());
+    rmdir(dir);
+    std::cout << std::endl;
+}
+
+// 三个缓存共享固定的字节预算，初始平均分配：
+// LRU的工作集大且均匀，多给空间收益明显；LFU只有300个热点，多给空间没有收益，但缩到300条以下就会损失命中；
+// ARC的工作集很大，增减空间的收益与损失都较小。
+// 每轮各缓存按自己的负载访问后执行一次平衡，观察预算逐步从ARC与LFU多余的部分流向LRU，LFU保持在300条
+void testCacheBalancer() {
+    std::cout << "\n=== 测试场景7：全局容量平衡测试 ===" << std::endl;
+    const size_t BYTES_PER_ENTRY = 64;
+    const size_t TOTAL_BYTES = 3000 * BYTES_PER_ENTRY;
+    const int ROUNDS = 12;
+    const int OPERATIONS_PER_ROUND = 20000;
+
+    KamaCache::KHashLruCaches<int, std::string> lru(1000, 4);
+    KamaCache::KHashLfuCache<int, std::string> lfu(1000, 4, 1000000);
+    KamaCache::KArcCache<int, std::string> arc(1000);
+
+    KamaCache::BalancerOptions options;
+    options.stepBytes = 100 * BYTES_PER_ENTRY;
+    KamaCache::KCacheBalancer balancer(TOTAL_BYTES, options);
+    auto& lruTracker = balancer.registerCache<int>("LRU", lru, BYTES_PER_ENTRY);
+    auto& lfuTracker = balancer.registerCache<int>("LFU", lfu, BYTES_PER_ENTRY);
+    auto& arcTracker = balancer.registerCache<int>("ARC", arc, BYTES_PER_ENTRY);
+
+    std::mt19937 gen(42);
+    auto access = [](auto& cache, auto& tracker, int key) {
+        std::string value;
+        bool hit = cache.get(key, value);
+        if (!hit) {
+            cache.put(key, "value" + std::to_string(key));
+        }
+        tracker.recordAccess(key, hit);
+        return hit;
+    };
+
+    for (int round = 1; round <= ROUNDS; ++round) {
+        int hits = 0;
+        for (int op = 0; op < OPERATIONS_PER_ROUND; ++op) {
+            hits += access(lru, lruTracker, gen() % 2000);
+            hits += access(lfu, lfuTracker, gen() % 300);
+            hits += access(arc, arcTracker, gen() % 20000);
+        }
+        balancer.rebalance();
+
+        std::cout << "第" << std::setw(2) << round << "轮 - 总命中率: " << std::fixed << std::setprecision(2)
+                  << 100.0 * hits / (3 * OPERATIONS_PER_ROUND) << "%";
+        for (const auto& allocation : balancer.allocations()) {
+            std::cout << ", " << allocation.name << ": " << allocation.capacity << "条("
+                      << std::setprecision(1) << 100.0 * allocation.hitRate << "%)";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+// 多个线程并发put/get/remove，key范围是容量的2倍，淘汰频繁发生，同一key常在被淘汰线程摘下后、删除索引前被重新put。
+// value为key*100+线程号，读到的value必须属于该key；运行中采样size()，超出容量的部分不应多于写线程数；
+// 结束后size()不超过容量，且与索引中实际能查到的key数一致(没有丢失或泄漏的结点)
+void testConcurrentLru() {
+    std::cout << "\n=== 测试场景8：索引锁与链表锁分离的LRU并发测试 ===" << std::endl;
+    const size_t CAPACITY = 1000;
+    const int KEY_RANGE = 2000;
+    const int OPERATIONS = 200000;
+    int threads = std::max(4u, std::thread::hardware_concurrency());
+    KamaCache::KConcurrentLruCache<int, int> cache(CAPACITY, 8);
+
+    std::atomic<bool> done(false);
+    std::atomic<int> corrupted(0);
+    std::atomic<int> hits(0);
+    size_t maxSize = 0;
+    std::thread sampler([&]() {
+        while (!done) {
+            maxSize = std::max(maxSize, cache.size());
+            std::this_thread::yield();
+        }
+    });
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            int value = 0;
+            for (int op = 0; op < OPERATIONS / threads; ++op) {
+                int key = gen() % KEY_RANGE;
+                int action = gen() % 100;
+                if (action < 40) {
+                    cache.put(key, key * 100 + t);
+                } else if (action < 45) {
+                    cache.remove(key);
+                } else if (cache.get(key, value)) {
+                    ++hits;
+                    if (value / 100 != key) ++corrupted;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ms = std::max(1.0, timer.elapsed());
+    done = true;
+    sampler.join();
+
+    size_t present = 0;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        if (cache.contains(key)) ++present;
+    }
+    bool ok = cache.size() <= CAPACITY && present == cache.size() && corrupted == 0
+           && maxSize <= CAPACITY + threads;
+    std::cout << std::fixed << std::setprecision(0) << threads << " 线程 - 耗时: " << ms << "ms, 吞吐: "
+              << OPERATIONS / ms * 1000 << " ops/s, 命中: " << hits << std::endl;
+    std::cout << "容量: " << CAPACITY << ", 运行中最大结点数: " << maxSize << ", 结束后结点数: " << cache.size()
+              << ", 索引中的key: " << present << ", 错误的value: " << corrupted << std::endl;
+    std::cout << (ok ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 分片LRU的热点分片：所有线程集中访问2个分片、每片200个热点key，80%读20%写。
+// 读到的value必须属于该key，结束后通过dump核对条目数不超过容量
+// 返回吞吐(ops/s)
+double benchShardedLru(const std::string& name, bool flatCombining, int threads, int opsPerThread) {
+    const int CAPACITY = 400;
+    const int KEY_RANGE = 600;
+    KamaCache::KHashLruCaches<int, int> cache(CAPACITY, 2, flatCombining);
+    std::atomic<int> corrupted(0);
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            int value = 0;
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = gen() % KEY_RANGE;
+                if (gen() % 100 < 20) {
+                    cache.put(key, key * 100 + t);
+                } else if (cache.get(key, value) && value / 100 != key) {
+                    ++corrupted;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ms = std::max(1.0, timer.elapsed());
+
+    size_t entries = 0;
+    cache.dump([&](const std::vector<std::pair<int, int>>& chunk) { entries += chunk.size(); });
+    bool ok = corrupted == 0 && entries <= CAPACITY;
+    double throughput = (threads * static_cast<double>(opsPerThread)) / ms * 1000;
+    std::cout << std::fixed << std::setprecision(0) << name << " - 耗时: " << ms << "ms, 吞吐: "
+              << throughput << " ops/s, 条目: " << entries
+              << (ok ? ", 检查通过" : ", 检查失败") << std::endl;
+    return throughput;
+}
+
+void testFlatCombining() {
+    std::cout << "\n=== 测试场景9：分片LRU平面合并测试 ===" << std::endl;
+    const int OPERATIONS = 400000;
+    // 平面合并只在大量线程争抢同一分片时才可能占优；线程少时发布槽与合并者交接的开销
+    // 往往让它比直接加锁更慢，所以这里从低竞争到高竞争各跑一组，只对比不预设结论
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    for (int threads : {4, std::max(16, hw * 4), std::max(64, hw * 16)}) {
+        std::cout << "--- " << threads << " 线程(每个热点分片约 " << threads / 2 << " 个) ---" << std::endl;
+        double locked = benchShardedLru("分片加锁", false, threads, OPERATIONS / threads);
+        double combined = benchShardedLru("平面合并", true, threads, OPERATIONS / threads);
+        std::cout << std::setprecision(2) << "平面合并/分片加锁 吞吐比: " << combined / locked << std::setprecision(0) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void benchWriteBuffer(const std::string& name, size_t writeBufferSize, int threads, int opsPerThread) {
+    const int KEY_RANGE = 20000;
+    KamaCache::KHashLruCaches<int, int> cache(KEY_RANGE / 2, 4, false, writeBufferSize);
+    std::atomic<int> corrupted(0);
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            int value = 0;
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = gen() % KEY_RANGE;
+                if (gen() % 100 < 30) {
+                    cache.put(key, key * 100 + t);
+                } else if (cache.get(key, value) && value / 100 != key) {
+                    ++corrupted;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ms = std::max(1.0, timer.elapsed());
+    std::cout << std::fixed << std::setprecision(0) << name << " - 耗时: " << ms << "ms, 吞吐: "
+              << (threads * static_cast<double>(opsPerThread)) / ms * 1000 << " ops/s";
+    KamaCache::WriteBufferStats stats = cache.writeBufferStats();
+    if (stats.batches > 0) {
+        std::cout << ", 每批写入: " << std::setprecision(1) << static_cast<double>(stats.applied) / stats.batches;
+    }
+    std::cout << (corrupted == 0 ? "" : ", 读到错误的值!") << std::endl;
+}
+
+// 写缓冲的读己之写：每个线程反复put(t, i)后立即get(t)，必须读到刚写入的i。
+// 所有线程写入同一个分片的同一个缓冲，其他线程已领取但尚未写完的入队单元会挡在自己的写入之前
+void testWriteBuffer() {
+    std::cout << "\n=== 测试场景11：分片LRU写缓冲读己之写测试 ===" << std::endl;
+    const int OPERATIONS = 200000;
+    int threads = std::max(8u, std::thread::hardware_concurrency());
+    KamaCache::KHashLruCaches<int, int> cache(100000, 1, false, 1024);
+    std::atomic<int> stale(0);
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            int value = 0;
+            for (int i = 1; i <= OPERATIONS / threads; ++i) {
+                cache.put(t, i);
+                if (!cache.get(t, value) || value != i) ++stale;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ms = std::max(1.0, timer.elapsed());
+    std::cout << std::fixed << std::setprecision(0) << threads << " 线程 - 耗时: " << ms << "ms, 吞吐: "
+              << 2.0 * OPERATIONS / ms * 1000 << " ops/s, 读到旧值: " << stale << std::endl;
+
+    // 与不带写缓冲的分片LRU对比：70%读30%写的随机key(同工作负载剧烈变化测试的读写比例)。
+    // 读取的key大多不在缓冲中，不触发排空，写入得以积累成批、每批只加一次分片锁；
+    // 吞吐差异取决于分片锁的竞争程度，核数少时主要看每批写入数(之前每次读都排空时约为1.4)
+    std::cout << "--- 70%读30%写, 随机key ---" << std::endl;
+    benchWriteBuffer("不带写缓冲", 0, threads, 5 * OPERATIONS / threads);
+    benchWriteBuffer("写缓冲(1024)", 1024, threads, 5 * OPERATIONS / threads);
+    std::cout << (stale == 0 ? "检查通过" : "检查失败") << std::endl << std::endl;
 }
 
-int main() {
+// 读穿透的加载合并：多个线程按相同顺序读取同一批不在缓存中的key，每个key只应加载一次。
+// 然后一个线程用getAllOrLoad批量加载一批key，批量加载只返回偶数key，加载期间其他线程对奇数key调用getOrLoad：
+// 等待者落空后应重新合并成一次单独加载，每个奇数key同样只加载一次。
+// 最后在单独加载与批量加载进行期间put同一个key，put的值应保留下来
+void testLoadCoalescing() {
+    std::cout << "\n=== 测试场景12：读穿透加载合并测试 ===" << std::endl;
+    const int KEYS = 200;
+    int threads = std::max(8u, std::thread::hardware_concurrency());
+    KamaCache::KHashLruCaches<int, int> cache(4 * KEYS, 4);
+    std::vector<std::atomic<int>> loads(2 * KEYS);
+    std::atomic<int> wrong(0);
+    auto loader = [&](int key) {
+        ++loads[key];
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        return key * 10;
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int key = 0; key < KEYS; ++key) {
+                if (cache.getOrLoad(key, loader) != key * 10) ++wrong;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    std::vector<int> bulkKeys;
+    for (int key = KEYS; key < 2 * KEYS; ++key) bulkKeys.push_back(key);
+    std::promise<void> registered;
+    std::shared_future<void> started = registered.get_future().share();
+    std::atomic<int> bulkCalls(0);
+    workers.emplace_back([&]() {
+        auto result = cache.getAllOrLoad(bulkKeys, [&](const std::vector<int>& keys) {
+            ++bulkCalls;
+            registered.set_value(); // 此时所有key都已登记为加载中
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            std::unordered_map<int, int> values;
+            for (int key : keys) {
+                if (key % 2 == 0) values[key] = key * 10;
+            }
+            return values;
+        });
+        if (result.size() != bulkKeys.size() / 2) ++wrong;
+    });
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            started.wait();
+            for (int key = KEYS + 1; key < 2 * KEYS; key += 2) {
+                if (cache.getOrLoad(key, loader) != key * 10) ++wrong;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    int duplicated = 0;
+    int missing = 0;
+    for (int key = 0; key < 2 * KEYS; ++key) {
+        int expected = (key >= KEYS && key % 2 == 0) ? 0 : 1; // 偶数的批量key由批量加载负责
+        if (loads[key] > expected) ++duplicated;
+        if (loads[key] < expected) ++missing;
+    }
+    std::cout << threads << " 线程 - 单独加载: "
+              << std::accumulate(loads.begin(), loads.end(), 0, [](int sum, const std::atomic<int>& n) { return sum + n.load(); })
+              << " 次, 批量加载: " << bulkCalls << " 次, 重复加载的key: " << duplicated << ", 错误的value: " << wrong
+              << std::endl;
+
+    // 加载期间put：加载结果(1)不应覆盖put写入的值(2)，加载方拿到的也应是2；批量加载中未被put的key正常写入
+    int overwritten = 0;
+    auto putDuringLoad = [&](KamaCache::KHashLruCaches<int, int>& target, int key) {
+        std::promise<void> loading;
+        std::future<void> loadStarted = loading.get_future();
+        auto slowLoad = [&](int) {
+            loading.set_value();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return 1;
+        };
+        int returned = 0;
+        std::thread single([&]() { returned = target.getOrLoad(key, slowLoad); });
+        loadStarted.wait();
+        target.put(key, 2);
+        single.join();
+        int value = 0;
+        if (returned != 2 || !target.get(key, value) || value != 2) ++overwritten;
+
+        std::promise<void> bulkLoading;
+        std::future<void> bulkStarted = bulkLoading.get_future();
+        std::unordered_map<int, int> result;
+        std::thread bulk([&]() {
+            result = target.getAllOrLoad({key + 1, key + 2}, [&](const std::vector<int>& keys) {
+                bulkLoading.set_value();
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                std::unordered_map<int, int> values;
+                for (int k : keys) values[k] = 1;
+                return values;
+            });
+        });
+        bulkStarted.wait();
+        target.put(key + 1, 2);
+        bulk.join();
+        if (result[key + 1] != 2 || !target.get(key + 1, value) || value != 2) ++overwritten;
+        if (result[key + 2] != 1 || !target.get(key + 2, value) || value != 1) ++overwritten;
+    };
+    KamaCache::KHashLruCaches<int, int> buffered(4 * KEYS, 4, false, 64);
+    putDuringLoad(cache, 3 * KEYS);
+    putDuringLoad(buffered, 3 * KEYS);
+    std::cout << "加载期间put后被加载结果覆盖(含写缓冲模式): " << overwritten << std::endl;
+    bool ok = duplicated == 0 && missing == 0 && wrong == 0 && bulkCalls == 1 && overwritten == 0;
+    std::cout << (ok ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 拷贝时按需抛出异常的value，用于检查分片线程上的异常能否回到调用方
+struct FragileValue {
+    int value = 0;
+    bool poison = false;
+
+    FragileValue() = default;
+    FragileValue(int v, bool p) : value(v), poison(p) {}
+    FragileValue(const FragileValue& other) : value(other.value), poison(other.poison) {
+        if (poison) throw std::runtime_error("copy failed");
+    }
+    FragileValue(FragileValue&&) = default;
+    FragileValue& operator=(const FragileValue&) = default;
+    FragileValue& operator=(FragileValue&&) = default;
+};
+
+// 多个线程通过putAsync/putBatch写入各自的key，再用getBatch与回调版getAsync读回，检查没有丢失或错位；
+// 再写入拷贝时抛出异常的value，以及让回调抛出异常，检查异常交给了future、分片线程仍能继续服务
+void testDelegatedLru() {
+    std::cout << "\n=== 测试场景10：分片线程委托LRU测试 ===" << std::endl;
+    const int SHARDS = 4;
+    const int KEYS_PER_THREAD = 200;
+    int threads = std::max(4u, std::thread::hardware_concurrency());
+    KamaCache::KDelegatedLruCaches<int, int> cache(threads * KEYS_PER_THREAD, SHARDS);
+
+    std::atomic<int> wrong(0);
+    std::atomic<int> callbackHits(0);
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            int base = t * KEYS_PER_THREAD;
+            std::vector<std::future<void>> writes;
+            std::vector<std::pair<int, int>> batch;
+            std::vector<int> keys;
+            for (int i = 0; i < KEYS_PER_THREAD; ++i) {
+                if (i % 2 == 0) {
+                    writes.push_back(cache.putAsync(base + i, (base + i) * 10));
+                } else {
+                    batch.emplace_back(base + i, (base + i) * 10);
+                }
+                keys.push_back(base + i);
+            }
+            cache.putBatch(batch);
+            for (auto& write : writes) write.get();
+
+            std::vector<std::optional<int>> values = cache.getBatch(keys);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (!values[i] || *values[i] != keys[i] * 10) ++wrong;
+            }
+            std::promise<void> done;
+            std::atomic<int> remaining(KEYS_PER_THREAD);
+            for (int key : keys) {
+                cache.getAsync(key, [&, key](std::optional<int> value) {
+                    if (value && *value == key * 10) ++callbackHits;
+                    if (--remaining == 0) done.set_value();
+                });
+            }
+            done.get_future().get();
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ms = std::max(1.0, timer.elapsed());
+    std::cout << std::fixed << std::setprecision(0) << threads << " 线程 - 耗时: " << ms << "ms, 错误的批量结果: "
+              << wrong << ", 回调命中: " << callbackHits << "/" << threads * KEYS_PER_THREAD << std::endl;
+
+    KamaCache::KDelegatedLruCaches<int, FragileValue> fragile(100, 2);
+    int caught = 0;
+    try {
+        fragile.putAsync(1, FragileValue(1, true)).get();
+    } catch (const std::runtime_error&) {
+        ++caught;
+    }
+    // 原地构造，避免在调用方拷贝时就抛出
+    std::vector<std::pair<int, FragileValue>> items;
+    items.reserve(2);
+    items.emplace_back(2, FragileValue(2, false));
+    items.emplace_back(3, FragileValue(3, true));
+    try {
+        fragile.putBatch(items);
+    } catch (const std::runtime_error&) {
+        ++caught;
+    }
+    std::promise<void> thrown;
+    fragile.getAsync(2, [&](std::optional<FragileValue>) {
+        thrown.set_value();
+        throw std::runtime_error("callback failed");
+    });
+    thrown.get_future().get();
+    FragileValue value;
+    bool alive = fragile.get(2, value) && value.value == 2 && !fragile.get(1, value);
+    std::cout << "抛给调用方的异常: " << caught << "/2, 回调抛出异常后分片仍可用: " << (alive ? "是" : "否") << std::endl;
+
+    bool ok = wrong == 0 && callbackHits == threads * KEYS_PER_THREAD && caught == 2 && alive;
+    std::cout << (ok ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// RCU快照表：写者不断用新版本整体重建表，读者并发读取。第v版中key的value为 v*KEYS + key，
+// 读到的value必须属于所查的key、表中的key始终命中(不会看到构建到一半的表)，同一读者看到的版本不倒退；
+// 不在表中的key始终未命中。宽限期回收旧表，ASan下读者访问到已释放的旧表会直接报错
+void testSnapshotCache() {
+    std::cout << "\n=== 测试场景13：RCU快照表发布测试 ===" << std::endl;
+    const int KEYS = 1000;
+    const int VERSIONS = 200;
+    int readers = std::max(4u, std::thread::hardware_concurrency());
+    auto build = [&](int version) {
+        std::vector<std::pair<int, int>> items;
+        for (int key = 0; key < KEYS; ++key) items.emplace_back(key, version * KEYS + key);
+        return items;
+    };
+    std::vector<std::pair<int, int>> initial = build(0);
+    KamaCache::KSnapshotCache<int, int> cache(initial.begin(), initial.end());
+
+    std::atomic<bool> done(false);
+    std::atomic<long long> reads(0);
+    std::atomic<int> wrong(0);
+    std::atomic<int> regressed(0);
+    std::atomic<int> phantom(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < readers; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            int lastVersion = 0;
+            long long local = 0;
+            int value = 0;
+            while (!done) {
+                int key = gen() % KEYS;
+                if (!cache.get(key, value) || value % KEYS != key) {
+                    ++wrong;
+                } else {
+                    if (value / KEYS < lastVersion) ++regressed;
+                    lastVersion = value / KEYS;
+                }
+                if (cache.contains(KEYS + key)) ++phantom;
+                ++local;
+            }
+            reads += local;
+        });
+    }
+
+    Timer timer;
+    for (int version = 1; version <= VERSIONS; ++version) {
+        std::vector<std::pair<int, int>> items = build(version);
+        cache.rebuild(items.begin(), items.end());
+    }
+    double ms = std::max(1.0, timer.elapsed());
+    done = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    int value = 0;
+    bool latest = cache.size() == static_cast<size_t>(KEYS) && cache.get(KEYS - 1, value)
+               && value == VERSIONS * KEYS + KEYS - 1;
+    bool ok = wrong == 0 && regressed == 0 && phantom == 0 && latest;
+    std::cout << std::fixed << std::setprecision(0) << readers << " 读线程 - 发布 " << VERSIONS << " 个版本耗时: "
+              << ms << "ms, 读取: " << reads << std::endl;
+    std::cout << "未命中或错误的value: " << wrong << ", 版本倒退: " << regressed << ", 不存在的key命中: " << phantom
+              << ", 最终为最新版本: " << (latest ? "是" : "否") << std::endl;
+    std::cout << (ok ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 批量预热：向容量为CAPACITY的缓存导入3倍容量的数据，检查恰好保留CAPACITY条，且保留与淘汰的顺序符合策略：
+// LRU/ARC按输入顺序保留最后导入的数据，随后写入一个新key时淘汰最先保留下来的那个；
+// LFU带访问次数导入时保留次数最高的数据，次数相同时同样先淘汰先导入的；分片版本在每个分片内各自遵循这一顺序
+void testBulkLoad() {
+    std::cout << "\n=== 测试场景14：批量预热测试 ===" << std::endl;
+    const int CAPACITY = 100;
+    const int INPUT = 3 * CAPACITY;
+    std::vector<std::pair<int, int>> items;
+    for (int key = 0; key < INPUT; ++key) items.emplace_back(key, key * 10);
+    bool allOk = true;
+
+    // 应恰好保留[first, INPUT)，再写入新key后淘汰first
+    auto checkOrder = [&](auto& cache, int first) {
+        for (int key = 0; key < INPUT; ++key) {
+            if (cache.contains(key) != (key >= first)) return false;
+        }
+        cache.put(INPUT, INPUT * 10);
+        return !cache.contains(first) && cache.contains(first + 1) && cache.contains(INPUT);
+    };
+    auto report = [&](const std::string& name, size_t input, size_t entries, size_t capacity, bool orderOk) {
+        bool ok = entries == capacity && orderOk;
+        allOk = allOk && ok;
+        std::cout << name << " - 导入: " << input << ", 保留: " << entries << "/" << capacity
+                  << ", 保留与淘汰顺序: " << (orderOk ? "正确" : "错误") << std::endl;
+    };
+
+    KamaCache::KLruCache<int, int> lru(CAPACITY);
+    lru.bulkLoad(items.begin(), items.end());
+    size_t lruEntries = lru.snapshot().size();
+    report("LRU", INPUT, lruEntries, CAPACITY, checkOrder(lru, INPUT - CAPACITY));
+
+    KamaCache::KArcCache<int, int> arc(CAPACITY);
+    arc.bulkLoad(items.begin(), items.end());
+    size_t arcEntries = arc.snapshot().t1.size();
+    report("ARC", INPUT, arcEntries, CAPACITY, checkOrder(arc, INPUT - CAPACITY));
+
+    KamaCache::KArcCache<int, int> arcClassic(CAPACITY, 2, KamaCache::ArcMode::Classic);
+    arcClassic.bulkLoad(items.begin(), items.end());
+    size_t classicEntries = arcClassic.snapshot().t1.size();
+    report("ARC-Classic", INPUT, classicEntries, CAPACITY, checkOrder(arcClassic, INPUT - CAPACITY));
+
+    KamaCache::KLfuCache<int, int> lfu(CAPACITY);
+    lfu.bulkLoad(items.begin(), items.end());
+    size_t lfuEntries = lfu.snapshot().size();
+    report("LFU", INPUT, lfuEntries, CAPACITY, checkOrder(lfu, INPUT - CAPACITY));
+
+    // key为3的倍数的访问3次，其余1次：恰好CAPACITY个高频key，低频key全部被挤出
+    std::vector<std::tuple<int, int, int>> weighted;
+    for (int key = 0; key < INPUT; ++key) weighted.emplace_back(key, key * 10, key % 3 == 0 ? 3 : 1);
+    KamaCache::KLfuCache<int, int> lfuWeighted(CAPACITY);
+    lfuWeighted.bulkLoad(weighted.begin(), weighted.end());
+    bool keptFrequent = true;
+    for (int key = 0; key < INPUT; ++key) {
+        if (lfuWeighted.contains(key) != (key % 3 == 0)) keptFrequent = false;
+    }
+    size_t weightedEntries = lfuWeighted.snapshot().size();
+    report("LFU(带次数)", INPUT, weightedEntries, CAPACITY, keptFrequent);
+
+    // 4个分片、每片CAPACITY条；std::hash<int>下key % 4决定分片，每个分片保留自己最后导入的CAPACITY个key
+    const int SLICES = 4;
+    std::vector<std::pair<int, int>> shardItems;
+    for (int key = 0; key < 3 * SLICES * CAPACITY; ++key) shardItems.emplace_back(key, key * 10);
+    int shardFirst = static_cast<int>(shardItems.size()) - SLICES * CAPACITY;
+    auto keptLast = [&](auto& cache) {
+        for (int key = 0; key < static_cast<int>(shardItems.size()); ++key) {
+            if (cache.contains(key) != (key >= shardFirst)) return false;
+        }
+        return true;
+    };
+
+    KamaCache::KHashLruCaches<int, int> hashLru(SLICES * CAPACITY, SLICES);
+    hashLru.bulkLoad(shardItems.begin(), shardItems.end());
+    size_t hashLruEntries = 0;
+    hashLru.dump([&](const std::vector<std::pair<int, int>>& chunk) { hashLruEntries += chunk.size(); });
+    report("分片LRU", shardItems.size(), hashLruEntries, SLICES * CAPACITY, keptLast(hashLru));
+
+    KamaCache::KHashLfuCache<int, int> hashLfu(SLICES * CAPACITY, SLICES);
+    hashLfu.bulkLoad(shardItems.begin(), shardItems.end());
+    size_t hashLfuEntries = 0;
+    hashLfu.dump([&](const std::vector<std::tuple<int, int, int>>& chunk) { hashLfuEntries += chunk.size(); });
+    report("分片LFU", shardItems.size(), hashLfuEntries, SLICES * CAPACITY, keptLast(hashLfu));
+
+    std::cout << (allOk ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 快照与分块导出：LRU快照按MRU -> LRU排列，LFU快照按访问次数从高到低、同次数内最近加入的在前；
+// 分块导出的每块不超过chunkSize，各块依次拼接后与快照一致，分片版本的导出覆盖每个条目且恰好一次
+void testSnapshotDump() {
+    std::cout << "\n=== 测试场景15：快照与分块导出测试 ===" << std::endl;
+    const int CAPACITY = 10;
+    const size_t CHUNK = 3;
+    bool allOk = true;
+    auto report = [&](const std::string& name, bool ok) {
+        allOk = allOk && ok;
+        std::cout << name << ": " << (ok ? "正确" : "错误") << std::endl;
+    };
+
+    // 依次写入0..9，再访问3和7：MRU -> LRU为 7 3 9 8 6 5 4 2 1 0
+    KamaCache::KLruCache<int, int> lru(CAPACITY);
+    for (int key = 0; key < CAPACITY; ++key) lru.put(key, key * 10);
+    int value = 0;
+    lru.get(3, value);
+    lru.get(7, value);
+    std::vector<int> expected = {7, 3, 9, 8, 6, 5, 4, 2, 1, 0};
+    std::vector<std::pair<int, int>> lruSnapshot = lru.snapshot();
+    bool lruOrdered = lruSnapshot.size() == expected.size();
+    for (size_t i = 0; lruOrdered && i < expected.size(); ++i) {
+        lruOrdered = lruSnapshot[i].first == expected[i] && lruSnapshot[i].second == expected[i] * 10;
+    }
+    report("LRU快照为MRU -> LRU", lruOrdered);
+
+    std::vector<std::pair<int, int>> concatenated;
+    std::vector<size_t> chunkSizes;
+    lru.dump([&](const std::vector<std::pair<int, int>>& chunk) {
+        chunkSizes.push_back(chunk.size());
+        concatenated.insert(concatenated.end(), chunk.begin(), chunk.end());
+    }, CHUNK);
+    report("LRU分块导出(每块3个)为 3 3 3 1 且拼接后与快照一致",
+           chunkSizes == std::vector<size_t>{3, 3, 3, 1} && concatenated == lruSnapshot);
+
+    // key k访问k % 3次(写入算一次)：次数3的在前，同次数内最近加入的在前
+    KamaCache::KLfuCache<int, int> lfu(CAPACITY);
+    for (int key = 0; key < CAPACITY; ++key) {
+        lfu.put(key, key * 10);
+        for (int i = 0; i < key % 3; ++i) lfu.get(key, value);
+    }
+    std::vector<std::tuple<int, int, int>> lfuSnapshot = lfu.snapshot();
+    expected = {8, 5, 2, 7, 4, 1, 9, 6, 3, 0};
+    bool lfuOrdered = lfuSnapshot.size() == expected.size();
+    for (size_t i = 0; lfuOrdered && i < expected.size(); ++i) {
+        lfuOrdered = std::get<0>(lfuSnapshot[i]) == expected[i] && std::get<2>(lfuSnapshot[i]) == expected[i] % 3 + 1;
+    }
+    report("LFU快照按访问次数从高到低", lfuOrdered);
+
+    // 分片导出：各分片的最后一块可以不满，其余块恰好chunkSize个
+    const int KEYS = 1000;
+    const size_t SHARD_CHUNK = 64;
+    KamaCache::KHashLruCaches<int, int> hashLru(KEYS, 4);
+    for (int key = 0; key < KEYS; ++key) hashLru.put(key, key * 10);
+    std::vector<int> seen(KEYS, 0);
+    size_t chunks = 0;
+    size_t partialChunks = 0;
+    bool valuesOk = true;
+    bool chunksOk = true;
+    hashLru.dump([&](const std::vector<std::pair<int, int>>& chunk) {
+        ++chunks;
+        if (chunk.empty() || chunk.size() > SHARD_CHUNK) chunksOk = false;
+        if (chunk.size() < SHARD_CHUNK) ++partialChunks;
+        for (const auto& entry : chunk) {
+            if (entry.first < 0 || entry.first >= KEYS || entry.second != entry.first * 10) {
+                valuesOk = false;
+                continue;
+            }
+            ++seen[entry.first];
+        }
+    }, SHARD_CHUNK);
+    bool exactlyOnce = std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; });
+    report("分片LRU分块导出覆盖每个条目恰好一次", exactlyOnce && valuesOk && chunksOk && partialChunks <= 4);
+    std::cout << "分片LRU导出: " << chunks << " 块, 其中不满的块: " << partialChunks << std::endl;
+
+    KamaCache::KHashLfuCache<int, int> hashLfu(KEYS, 4);
+    for (int key = 0; key < KEYS; ++key) hashLfu.put(key, key * 10);
+    std::fill(seen.begin(), seen.end(), 0);
+    hashLfu.dump([&](const std::vector<std::tuple<int, int, int>>& chunk) {
+        for (const auto& entry : chunk) ++seen[std::get<0>(entry)];
+    }, SHARD_CHUNK);
+    exactlyOnce = std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; });
+    report("分片LFU分块导出覆盖每个条目恰好一次", exactlyOnce);
+
+    std::cout << (allOk ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 只读查询不改变策略状态：容量3的缓存写入1 2 3后反复peek/contains/getIfPresentQuiet最久未访问的1，
+// 再写入4时被淘汰的仍应是1；作为对照，改用get访问1后被淘汰的应是2。
+// LFU的访问次数与ARC的访问计数在只读查询后不变，peek再多次也不会把条目转入LFU部分
+void testQuietLookups() {
+    std::cout << "\n=== 测试场景16：只读查询不改变策略状态测试 ===" << std::endl;
+    const int PEEKS = 5;
+    bool allOk = true;
+    auto report = [&](const std::string& name, bool ok) {
+        allOk = allOk && ok;
+        std::cout << name << ": " << (ok ? "正确" : "错误") << std::endl;
+    };
+
+    // quiet为true时用只读查询访问1，返回写入4后被淘汰的key
+    auto evictedAfter = [&](auto& cache, bool quiet) {
+        for (int key = 1; key <= 3; ++key) cache.put(key, key * 10);
+        int value = 0;
+        for (int i = 0; i < PEEKS; ++i) {
+            if (quiet) {
+                cache.peek(1, value);
+                cache.contains(1);
+                cache.getIfPresentQuiet(1);
+            } else {
+                cache.get(1, value);
+            }
+        }
+        cache.put(4, 40);
+        for (int key = 1; key <= 3; ++key) {
+            if (!cache.contains(key)) return key;
+        }
+        return 0;
+    };
+    auto checkTail = [&](const std::string& name, auto makeCache) {
+        auto quietCache = makeCache();
+        auto touchedCache = makeCache();
+        int quietEvicted = evictedAfter(*quietCache, true);
+        int touchedEvicted = evictedAfter(*touchedCache, false);
+        std::cout << name << " - 只读查询后淘汰: " << quietEvicted << ", get后淘汰: " << touchedEvicted << std::endl;
+        report(name + " 只读查询不挽救LRU尾部", quietEvicted == 1 && touchedEvicted == 2);
+    };
+
+    checkTail("LRU", [] { return std::make_unique<KamaCache::KLruCache<int, int>>(3); });
+    checkTail("分离锁LRU", [] { return std::make_unique<KamaCache::KConcurrentLruCache<int, int>>(3, 1); });
+    checkTail("ARC-Classic", [] {
+        return std::make_unique<KamaCache::KArcCache<int, int>>(3, 2, KamaCache::ArcMode::Classic);
+    });
+    checkTail("分片LRU", [] { return std::make_unique<KamaCache::KHashLruCaches<int, int>>(3, 1); });
+
+    // LFU：写入后get两次，访问次数为3；只读查询若干次后仍为3
+    KamaCache::KLfuCache<int, int> lfu(3);
+    lfu.put(1, 10);
+    int value = 0;
+    lfu.get(1, value);
+    lfu.get(1, value);
+    for (int i = 0; i < PEEKS; ++i) {
+        lfu.peek(1, value);
+        lfu.contains(1);
+        lfu.getIfPresentQuiet(1);
+    }
+    std::vector<std::tuple<int, int, int>> lfuSnapshot = lfu.snapshot();
+    int freq = lfuSnapshot.size() == 1 ? std::get<2>(lfuSnapshot[0]) : -1;
+    std::cout << "LFU - 只读查询" << PEEKS << "轮后访问次数: " << freq << std::endl;
+    report("LFU 只读查询不增加访问次数", freq == 3);
+
+    // ARC(Split)：访问次数达到转换阈值2时条目会进入LFU部分，只读查询不计数
+    KamaCache::KArcCache<int, int> arc(3, 2);
+    arc.put(1, 10);
+    for (int i = 0; i < PEEKS; ++i) {
+        arc.peek(1, value);
+        arc.contains(1);
+        arc.getIfPresentQuiet(1);
+    }
+    bool stayedInLru = arc.snapshot().t2.empty();
+    arc.get(1, value);
+    arc.get(1, value);
+    bool promoted = !arc.snapshot().t2.empty();
+    report("ARC 只读查询不计入转换阈值", stayedInLru && promoted);
+
+    std::cout << (allOk ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 原子读改写：多个线程对少数几个共享key交替调用merge(key, 1, +)与compute(key, ++)，
+// 所有更新都在分片锁(或合并者)内原地完成，结束后各key之和应恰好等于总操作数；
+// 对不存在的key调用computeIfPresent应返回false且不插入
+template<typename Cache>
+bool runAtomicUpdates(const std::string& name, Cache& cache, int threads, int opsPerThread) {
+    const int KEYS = 4;
+    auto plus = [](int& current, const int& delta) { current += delta; };
+    auto increment = [](int& current) { ++current; };
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = (op + t) % KEYS;
+                if (op % 2 == 0) {
+                    cache.merge(key, 1, plus);
+                } else {
+                    cache.compute(key, increment);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double ms = std::max(1.0, timer.elapsed());
+
+    long long sum = 0;
+    int value = 0;
+    for (int key = 0; key < KEYS; ++key) {
+        if (cache.get(key, value)) sum += value;
+    }
+    bool missingUntouched = !cache.computeIfPresent(KEYS, increment) && !cache.contains(KEYS);
+    long long expected = static_cast<long long>(threads) * opsPerThread;
+    bool ok = sum == expected && missingUntouched;
+    std::cout << std::fixed << std::setprecision(0) << name << " - 耗时: " << ms << "ms, 各key之和: " << sum
+              << "/" << expected << (ok ? ", 检查通过" : ", 检查失败") << std::endl;
+    return ok;
+}
+
+void testAtomicUpdates() {
+    std::cout << "\n=== 测试场景17：原子读改写测试 ===" << std::endl;
+    const int OPERATIONS = 200000;
+    int threads = std::max(4u, std::thread::hardware_concurrency());
+    std::cout << "--- " << threads << " 线程 ---" << std::endl;
+
+    KamaCache::KHashLruCaches<int, int> hashLru(1000, 4);
+    KamaCache::KHashLruCaches<int, int> combinedLru(1000, 4, true);
+    KamaCache::KHashLruCaches<int, int> bufferedLru(1000, 4, false, 64);
+    KamaCache::KHashLfuCache<int, int> hashLfu(1000, 4);
+    bool ok = runAtomicUpdates("分片LRU", hashLru, threads, OPERATIONS / threads);
+    ok = runAtomicUpdates("分片LRU(平面合并)", combinedLru, threads, OPERATIONS / threads) && ok;
+    ok = runAtomicUpdates("分片LRU(写缓冲)", bufferedLru, threads, OPERATIONS / threads) && ok;
+    ok = runAtomicUpdates("分片LFU", hashLfu, threads, OPERATIONS / threads) && ok;
+    std::cout << (ok ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 加载期间的写入：loader需要50ms并总是返回1，在它执行期间put(key, 新值)。
+// 分别覆盖未命中时的同步加载、XFetch提前刷新与stale-while-revalidate的后台刷新，
+// 加载结束后缓存中应保留put写入的值，不被更早开始的加载结果覆盖
+void testTtlPutDuringLoad() {
+    std::cout << "\n=== 测试场景18：TTL加载期间写入测试 ===" << std::endl;
+    using namespace std::chrono_literals;
+    std::atomic<int> started(0);
+    auto loader = [&](int) {
+        ++started;
+        std::this_thread::sleep_for(50ms);
+        return 1;
+    };
+    auto waitStarted = [&](int count) {
+        while (started < count) std::this_thread::yield();
+    };
+    bool allOk = true;
+    auto report = [&](const std::string& name, int cached, int returned, int expected) {
+        bool ok = cached == expected && returned == expected;
+        allOk = allOk && ok;
+        std::cout << name << " - 缓存中的值: " << cached << ", 加载方拿到的值: " << returned
+                  << (ok ? ", 写入保留" : ", 写入被加载结果覆盖") << std::endl;
+    };
+    int value = 0;
+
+    // 未命中：加载方与等待者都拿到put写入的值
+    {
+        started = 0;
+        KamaCache::KTtlCache<int, int> cache(16, 10s, loader, 0.0);
+        int returned = 0;
+        std::thread reader([&]() { returned = cache.getOrLoad(1); });
+        waitStarted(1);
+        cache.put(1, 2);
+        reader.join();
+        cache.get(1, value);
+        report("未命中加载", value, returned, 2);
+    }
+
+    // XFetch：首次加载记下50ms的耗时，beta很大时读取大概率提前刷新；是否刷新是随机的，读到没有触发刷新就再读
+    {
+        started = 0;
+        KamaCache::KTtlCache<int, int> cache(16, 10s, loader, 1000.0);
+        cache.getOrLoad(1);
+        int returned = 0;
+        std::thread reader([&]() {
+            do {
+                returned = cache.getOrLoad(1);
+            } while (started < 2);
+        });
+        waitStarted(2);
+        cache.put(1, 3);
+        reader.join();
+        cache.get(1, value);
+        report("XFetch提前刷新", value, returned, 3);
+    }
+
+    // stale-while-revalidate：读到过期值的调用方立即返回，刷新在后台线程进行
+    {
+        started = 0;
+        KamaCache::TtlStaleOptions swr;
+        swr.whileRevalidate = 10s;
+        KamaCache::KTtlCache<int, int> cache(16, 10s, loader, 0.0, swr);
+        cache.put(1, 0, 20ms);
+        std::this_thread::sleep_for(30ms);
+        cache.getOrLoad(1);
+        waitStarted(1);
+        cache.put(1, 4);
+        std::this_thread::sleep_for(100ms); // 等后台刷新结束
+        cache.get(1, value);
+        report("后台刷新", value, cache.getOrLoad(1), 4);
+    }
+
+    std::cout << (allOk ? "检查通过" : "检查失败") << std::endl << std::endl;
+}
+
+// 本进程用户态的数据TLB读未命中计数；内核不支持或perf_event_paranoid不允许时available()为false
+class DtlbMissCounter {
+public:
+    DtlbMissCounter() : fd_(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~DtlbMissCounter() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool available() const { return fd_ >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd_;
+};
+
+// 本进程由透明大页映射的匿名内存(KB)，不可读时为0
+uint64_t anonHugePagesKb() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            return std::strtoull(line.c_str() + 14, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// 随机顺序写满capacity个条目后随机读取，key范围比容量大1/4，未命中时写入(淘汰的结点被后续插入复用)。
+// 单线程、空锁，耗时主要来自结点与索引的访存
+template<typename Alloc>
+void benchNodeAllocator(const std::string& name, int capacity, const Alloc& alloc) {
+    const int OPERATIONS = 10000000;
+    const int KEY_RANGE = capacity + capacity / 4;
+    uint64_t hugeBefore = anonHugePagesKb();
+    KamaCache::KLruCache<int, int, KamaCache::KNullLock, Alloc> cache(capacity, alloc);
+
+    std::mt19937 gen(42);
+    std::vector<int> keys(capacity);
+    for (int i = 0; i < capacity; ++i) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), gen);
+    for (int key : keys) {
+        cache.put(key, key);
+    }
+    std::vector<int>().swap(keys);
+    uint64_t hugeAfter = anonHugePagesKb();
+
+    DtlbMissCounter counter;
+    int hits = 0;
+    int value = 0;
+    Timer timer;
+    counter.start();
+    for (int op = 0; op < OPERATIONS; ++op) {
+        int key = gen() % KEY_RANGE;
+        if (cache.get(key, value)) {
+            ++hits;
+        } else {
+            cache.put(key, key);
+        }
+    }
+    uint64_t misses = counter.stop();
+    double ms = std::max(1.0, timer.elapsed());
+
+    std::cout << std::fixed << std::setprecision(0) << name << " - 吞吐: " << OPERATIONS / ms * 1000 << " ops/s";
+    if (counter.available()) {
+        std::cout << ", dTLB未命中: " << std::setprecision(3) << static_cast<double>(misses) / OPERATIONS << "/op";
+    } else {
+        std::cout << ", dTLB未命中: 不可用";
+    }
+    std::cout << ", 透明大页: " << (hugeAfter > hugeBefore ? (hugeAfter - hugeBefore) / 1024 : 0) << "MB"
+              << ", 命中率: " << std::setprecision(2) << 100.0 * hits / OPERATIONS << "%" << std::endl;
+}
+
+// 多线程访问分片LRU：各线程随机读写，未命中时写入，淘汰与插入不断释放、分配结点。
+// 所有分片共用同一个分配器，池若用一把全局锁会把分片缓存重新串行化
+template<typename Alloc>
+void benchShardedAllocator(const std::string& name, int capacity, const Alloc& alloc) {
+    const int threads = std::max(4u, std::thread::hardware_concurrency());
+    const int OPERATIONS_PER_THREAD = 2000000;
+    const int KEY_RANGE = capacity + capacity / 4;
+    KamaCache::KHashLruCaches<int, int, std::mutex, Alloc> cache(capacity, threads, false, 0, alloc);
+    for (int key = 0; key < capacity; ++key) {
+        cache.put(key, key);
+    }
+
+    std::atomic<long long> hits{0};
+    std::atomic<int> wrong{0};
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t + 1);
+            int value = 0;
+            long long localHits = 0;
+            for (int op = 0; op < OPERATIONS_PER_THREAD; ++op) {
+                int key = gen() % KEY_RANGE;
+                if (cache.get(key, value)) {
+                    ++localHits;
+                    if (value != key) wrong.fetch_add(1);
+                } else {
+                    cache.put(key, key);
+                }
+            }
+            hits.fetch_add(localHits);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double ms = std::max(1.0, timer.elapsed());
+
+    long long total = static_cast<long long>(threads) * OPERATIONS_PER_THREAD;
+    std::cout << std::fixed << std::setprecision(0) << name << " (" << threads << "线程分片) - 吞吐: "
+              << total / ms * 1000 << " ops/s, 命中率: " << std::setprecision(2) << 100.0 * hits / total << "%"
+              << (wrong == 0 ? "" : ", 读到错误的值!") << std::endl;
+}
+
+// 大容量下结点分配方式对比：默认分配器的结点与索引散落在4KB页上，随机访问时dTLB频繁未命中；
+// 内存池把它们集中在2MB大页上。HugeTlb模式需要预留大页(vm.nr_hugepages)，否则退回透明大页
+void testHugePages(int capacity) {
+    std::cout << "\n=== 大页结点内存池测试 (容量 " << capacity << ") ===" << std::endl;
+    if (!DtlbMissCounter().available()) {
+        std::cout << "(perf_event_open不可用，只比较吞吐)" << std::endl;
+    }
+
+    benchNodeAllocator("std::allocator", capacity, std::allocator<char>());
+
+    const std::vector<std::pair<KamaCache::HugePageMode, std::string>> modes = {
+        {KamaCache::HugePageMode::Disabled, "Arena(4KB)"},
+        {KamaCache::HugePageMode::Transparent, "Arena(THP)"},
+        {KamaCache::HugePageMode::HugeTlb, "Arena(hugetlb)"},
+    };
+    for (const auto& mode : modes) {
+        KamaCache::KHugePageArena arena(mode.first);
+        benchNodeAllocator(mode.second, capacity, KamaCache::HugePageAllocator<char>(arena));
+        KamaCache::ArenaStats stats = arena.stats();
+        std::cout << "  池映射: " << stats.mappedBytes / (1 << 20) << "MB, 其中hugetlb: "
+                  << stats.hugeTlbBytes / (1 << 20) << "MB" << std::endl;
+    }
+
+    // 分片缓存的桶数组在各分片扩容时从池中分配，1MB以内的都从大块中切分，不再各占一个2MB映射
+    benchShardedAllocator("std::allocator", capacity, std::allocator<char>());
+    {
+        KamaCache::KHugePageArena arena(KamaCache::HugePageMode::Transparent);
+        benchShardedAllocator("Arena(THP)", capacity, KamaCache::HugePageAllocator<char>(arena));
+        KamaCache::ArenaStats stats = arena.stats();
+        std::cout << "  池映射: " << stats.mappedBytes / (1 << 20) << "MB" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+// 读取轨迹文件：每行 "key [size]"，空行与#开头的行忽略。文件以mmap方式只读映射。
+// key可以是任意64位整数(如块地址)，按首次出现的顺序重新编号为稠密的int，相等关系不变，回放与OPT都不受影响
+bool loadTrace(const char* path, std::vector<int>& keys, std::vector<uint64_t>& sizes, bool& hasSize) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "无法打开轨迹文件: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        std::cerr << "轨迹文件为空: " << path << std::endl;
+        return false;
+    }
+    size_t length = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "mmap失败: " << path << std::endl;
+        return false;
+    }
+
+    const char* p = static_cast<const char*>(mapped);
+    const char* end = p + length;
+    hasSize = false;
+    size_t malformed = 0;
+    size_t firstMalformed = 0;
+    size_t lineNo = 0;
+    std::unordered_map<long long, int> denseIds;
+    auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+    while (p < end) {
+        ++lineNo;
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        while (p < lineEnd && isSpace(*p)) ++p;
+        if (p < lineEnd && *p != '#') {
+            // 逐字符解析，避免strtoll越过映射区末尾。key与size之后只能是空白，否则整行跳过
+            bool negative = (*p == '-');
+            if (negative) ++p;
+            const char* digits = p;
+            long long key = 0;
+            bool overflow = false;
+            while (p < lineEnd && *p >= '0' && *p <= '9') {
+                int digit = *p++ - '0';
+                if (key > (std::numeric_limits<long long>::max() - digit) / 10) overflow = true;
+                else key = key * 10 + digit;
+            }
+            bool valid = p > digits && !overflow && (p == lineEnd || isSpace(*p));
+            while (p < lineEnd && isSpace(*p)) ++p;
+            uint64_t size = 0;
+            while (p < lineEnd && *p >= '0' && *p <= '9') size = size * 10 + (*p++ - '0');
+            while (p < lineEnd && isSpace(*p)) ++p;
+            if (valid && p == lineEnd) {
+                if (size > 0) hasSize = true;
+                int id = static_cast<int>(denseIds.size());
+                keys.push_back(denseIds.emplace(negative ? -key : key, id).first->second);
+                sizes.push_back(size > 0 ? size : 1);
+            } else if (malformed++ == 0) {
+                firstMalformed = lineNo;
+            }
+        }
+        if (lineEnd == end) break;
+        p = lineEnd + 1;
+    }
+    munmap(mapped, length);
+
+    if (malformed > 0) {
+        std::cerr << "跳过 " << malformed << " 行格式错误的记录(首个在第 " << firstMalformed << " 行)" << std::endl;
+    }
+    if (keys.empty()) {
+        std::cerr << "轨迹文件中没有有效记录: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 轨迹回放：每条记录视为一次读请求，未命中时写入缓存；同时给出同容量下Belady MIN的最优命中率
+void replayTrace(const char* path, int capacity, uint64_t capacityBytes) {
+    std::vector<int> keys;
+    std::vector<uint64_t> sizes;
+    bool hasSize = false;
+    if (!loadTrace(path, keys, sizes, hasSize)) return;
+
+    std::cout << "\n=== 轨迹回放: " << path << " (" << keys.size() << " 次访问) ===" << std::endl;
+
+    KamaCache::KLruCache<int, std::string> lru(capacity);
+    KamaCache::KLfuCache<int, std::string> lfu(capacity);
+    KamaCache::KArcCache<int, std::string> arc(capacity);
+    KamaCache::KLruKCache<int, std::string> lruk(capacity, 500, 2);
+    KamaCache::KLfuCache<int, std::string> lfuAging(capacity, 10000);
+    KamaCache::KArcCache<int, std::string> arcClassic(capacity, 2, KamaCache::ArcMode::Classic);
+    KamaCache::KLruKDistanceCache<int, std::string> lrukDist(capacity, 2, 500);
+    KamaCache::KLfuLogCache<int, std::string> lfuLog(capacity);
+    KamaCache::KSampledCache<int, std::string> lruSampled(capacity, KamaCache::SampledPolicy::Lru);
+    KamaCache::KCarCache<int, std::string> car(capacity);
+    KamaCache::KHyperbolicCache<int, std::string> hyperbolic(capacity);
+
+    std::vector<KamaCache::KICachePolicy<int, std::string>*> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &arcClassic, &lrukDist, &lfuLog, &lruSampled, &car, &hyperbolic};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "ARC-Classic", "LRU-K-Dist", "LFU-Log", "LRU-Sampled", "CAR", "Hyperbolic"};
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        for (int key : keys) {
+            std::string result;
+            get_operations[i]++;
+            if (caches[i]->get(key, result)) {
+                hits[i]++;
+            } else {
+                caches[i]->put(key, "value" + std::to_string(key));
+            }
+        }
+    }
+
+    KamaCache::KBeladyOracle<int> oracle(keys, sizes);
+    KamaCache::BeladyResult opt = oracle.min(capacity);
+    names.push_back("OPT");
+    get_operations.push_back(static_cast<int>(opt.requests));
+    hits.push_back(static_cast<int>(opt.hits));
+    printResults("轨迹回放", capacity, names, get_operations, hits);
+
+    if (hasSize) {
+        if (capacityBytes == 0) {
+            // 默认字节容量：条目容量乘以平均条目大小
+            uint64_t total = 0;
+            for (uint64_t size : sizes) total += size;
+            capacityBytes = total / sizes.size() * capacity;
+        }
+        KamaCache::BeladyResult optSize = oracle.minSize(capacityBytes);
+        std::cout << "OPT-Size (容量 " << capacityBytes << " 字节) - 命中率: " << std::fixed << std::setprecision(2)
+                  << 100.0 * optSize.hits / optSize.requests << "%, 字节命中率: "
+                  << 100.0 * optSize.hitBytes / optSize.requestBytes << "%" << std::endl;
+    }
+}
+
+// 不带参数时运行内置测试场景；带参数时回放轨迹: main <trace> [capacity] [capacityBytes]；
+// main --hugepage [capacity] 运行大页结点内存池测试(默认200万条，耗时与内存较大，不在内置场景中)
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--hugepage") == 0) {
+        testHugePages(argc > 2 ? std::atoi(argv[2]) : 2000000);
+        return 0;
+    }
+    if (argc > 1) {
+        int capacity = argc > 2 ? std::atoi(argv[2]) : 30;
+        uint64_t capacityBytes = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0;
+        replayTrace(argv[1], capacity, capacityBytes);
+        return 0;
+    }
+
     testHotDataAccess();
     testLoopPattern();
     testWorkloadShift();
+    testLockPolicies();
+    testTtlStampede();
+    testMemoryGovernor();
+    testCacheBalancer();
+    testConcurrentLru();
+    testFlatCombining();
+    testDelegatedLru();
+    testWriteBuffer();
+    testLoadCoalescing();
+    testSnapshotCache();
+    testBulkLoad();
+    testSnapshotDump();
+    testQuietLookups();
+    testAtomicUpdates();
+    testTtlPutDuringLoad();
     return 0;
 }
\ No newline at end of file